@@ -10,14 +10,43 @@
 #define INC_BUZZER_H_
 
 #include <stdint.h>
+#include "pwm_utils.h"
+
+// Tones with precomputed timer settings
+typedef enum
+{
+  TONE_250_HZ,
+  TONE_500_HZ,
+  TONE_1000_HZ,
+  TONE_2000_HZ,
+  TONE_4000_HZ,
+  NUM_OF_TONES
+} BuzzerTone;
+
+// Duty cycles with precomputed timer settings; a piezo buzzer is loudest at 50%
+typedef enum
+{
+  VOLUME_MUTE,   // 0%
+  VOLUME_LOW,    // 10%
+  VOLUME_MEDIUM, // 25%
+  VOLUME_HIGH,   // 50%
+  NUM_OF_VOLUMES
+} BuzzerVolume;
 
 void initBuzzer(void);
 
-void buzzerOn(uint16_t freqHz);
+void buzzerOn(BuzzerTone tone);
 void buzzerOff(void);
 
-void updateBuzzerFrequency(uint16_t freqHz);
+void setBuzzerTone(BuzzerTone tone);
+void setBuzzerVolume(BuzzerVolume volume);
+void applyBuzzerSettings(void);
+uint8_t computeBuzzerRegisters(uint16_t freqHz, BuzzerVolume volume, PwmRegisters* regs);
 void muteBuzzer();
 void unMuteBuzzer();
 
+void startBuzzerCadence(uint16_t onMs, uint32_t offMs);
+void updateBuzzerCadence(uint16_t onMs, uint32_t offMs);
+void stopBuzzerCadence(void);
+
 #endif /* INC_BUZZER_H_ */
@@ -0,0 +1,63 @@
+/*******************************************************************************
+  * File Name          : cir_capture.h
+  * Description        :
+  *    Channel impulse response (CIR) dumps. After each good response the
+  *    Ipatov CIR around the first path is read from the DW3000 accumulator
+  *    and streamed over USART2. The full Ipatov CIR is dumped once after the
+  *    user button (B1) is pressed or requestFullCirCapture() is called.
+  *    Tools/cir_dump.py stores the dumps in an indexed file.
+  *
+  *    Two capture buffers take turns: while one dump is sent by USART2 TX
+  *    DMA straight from its buffer, the next one is captured into the other.
+  *    A dump is dropped and counted when both buffers are still in use.
+  *
+  *    Frame on the wire: 0x00, COBS(dump, CRC), 0x00, framed like the
+  *    telemetry records (see telemetry.h) but longer than 254 bytes.
+  *
+  *    Dump, version 1, little endian, a 28-byte header followed by the
+  *    samples and a CRC-16/CCITT of the header and samples, low byte first:
+  *      offset  size  field
+  *       0      1     type          CIR_FRAME_TYPE
+  *       1      1     version       CIR_FORMAT_VERSION
+  *       2      2     sequence      Dump counter, gaps mean dropped dumps
+  *       4      4     timestampMs   HAL_GetTick() at the capture
+  *       8      2     firstSample   Accumulator index of the first sample
+  *      10      2     numSamples    Number of samples
+  *      12      2     fpIndex       Ipatov first path index, 10.6 fixed point
+  *      14      2     accumCount    Ipatov accumulated preamble symbols
+  *      16      4     cirPeak       Ipatov CIR peak: index [30:21], amplitude [20:0]
+  *      20      1     flags         CIR_FLAG_* below
+  *      21      1     chan          dwt_config_t of the exchange: channel,
+  *      22      1     txPreambLength  preamble length, PAC size, preamble
+  *      23      1     rxPAC           code, SFD type and data rate
+  *      24      1     rxCode
+  *      25      1     sfdType
+  *      26      1     dataRate
+  *      27      1     reserved      0
+  *      28      6*n   samples       Real then imaginary part, 3 bytes each,
+  *                                  18-bit signed in bits [17:0]
+  ******************************************************************************
+  */
+#ifndef INC_CIR_CAPTURE_H_
+#define INC_CIR_CAPTURE_H_
+
+#include <stdint.h>
+#include <deca_device_api.h>
+
+#define CIR_CAPTURE_ENABLE  1    // 0: no dumps, saves the 12.3 kB of capture buffers
+#define CIR_FRAME_TYPE      0xC1 // First payload byte of a CIR dump frame
+#define CIR_FORMAT_VERSION  1
+
+#define CIR_IPATOV_SAMPLES  1016 // Ipatov CIR length at 64 MHz PRF
+#define CIR_SAMPLE_BYTES    6
+#define CIR_WINDOW_SAMPLES  64   // Samples of a dump around the first path
+#define CIR_WINDOW_LEAD     16   // Samples of that window before the first path
+
+// Dump flags
+#define CIR_FLAG_FULL       0x01 // The whole Ipatov CIR, not a window
+
+void captureCir(const dwt_config_t* config, const dwt_rxharvest_t* harvest);
+void requestFullCirCapture(void);
+uint32_t getCirCaptureDrops(void);
+
+#endif /* INC_CIR_CAPTURE_H_ */
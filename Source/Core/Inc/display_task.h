@@ -0,0 +1,20 @@
+/*******************************************************************************
+  * File Name          : display_task.h
+  * Description        :
+  *    Renders the latest ranging result on the OLED display at a fixed frame
+  *    rate, decoupled from the ranging task by a single-slot mailbox.
+  ******************************************************************************
+  */
+#ifndef INC_DISPLAY_TASK_H_
+#define INC_DISPLAY_TASK_H_
+
+#include <stdint.h>
+
+#define DISPLAY_FRAME_RATE_HZ 20 // Frames rendered per second at most
+
+void initDisplayTask(void);
+void publishRange(double distance);
+void publishNoRange(void);
+void pollDisplayTask(void);
+
+#endif /* INC_DISPLAY_TASK_H_ */
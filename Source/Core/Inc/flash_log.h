@@ -0,0 +1,70 @@
+/*******************************************************************************
+  * File Name          : flash_log.h
+  * Description        :
+  *    Ring log of the ranging exchanges in flash sectors 6 and 7
+  *    (0x08040000 to 0x0807FFFF), kept over power cycles. The linker
+  *    scripts end the firmware before these sectors.
+  *
+  *    Each exchange is appended as a delta encoded record of 7 to 9 bytes,
+  *    about 4.5 hours at one exchange a second per sector. Records are
+  *    staged in RAM and programmed a few words at a time by pollFlashLog().
+  *    When a sector is full, the other one is erased and written next, so
+  *    the log holds the newest 4.5 to 9 hours and both sectors wear evenly.
+  *
+  *    Sector: 16-byte header, then records back to back:
+  *      offset  size  field
+  *       0      4     magic         FLASH_LOG_MAGIC
+  *       4      4     sequence      Incremented on each erase, the highest is written
+  *       8      1     version       FLASH_LOG_VERSION
+  *       9      5     reserved      0
+  *      14      2     CRC-16/CCITT of bytes 0 to 13, low byte first
+  *
+  *    Record: length (1 to 254), payload, CRC-16/CCITT of the length and
+  *    the payload. A 0x00 byte is padding and 0xFF ends the log. A record
+  *    cut by a power loss fails its CRC and is skipped.
+  *
+  *    Payload, the first byte is the record type:
+  *      FLASH_LOG_SESSION  Power up; the time and range deltas start over
+  *      FLASH_LOG_RANGE    varint timestamp delta in ms, flags (TLM_FLAG_*),
+  *                         and with TLM_FLAG_RANGE_VALID a zigzag varint
+  *                         range delta in mm from the last valid range
+  *    Varints are 7 bits a byte, low bits first. The deltas also start over
+  *    at the start of a sector.
+  *
+  *    Sending FLASH_LOG_DUMP_COMMAND to USART2 dumps both sectors, oldest
+  *    first, in frames like the telemetry records (see telemetry.h):
+  *      0xD1, sector sequence (4), offset (4), up to 192 bytes of the sector
+  *      0xD2, number of 0xD1 frames (2), dropped records (4), flags
+  *    Tools/flash_log.py sends the command and decodes the dump.
+  ******************************************************************************
+  */
+#ifndef INC_FLASH_LOG_H_
+#define INC_FLASH_LOG_H_
+
+#include <stdint.h>
+#include "telemetry.h"
+
+#define FLASH_LOG_ENABLE        1   // 0: nothing is written to flash
+#define FLASH_LOG_MAGIC         0x474F4C55 // "ULOG"
+#define FLASH_LOG_VERSION       1
+#define FLASH_LOG_DUMP_COMMAND  'D'
+
+// Record types
+#define FLASH_LOG_SESSION       0x01
+#define FLASH_LOG_RANGE         0x02
+
+// Dump frame types
+#define FLASH_LOG_DUMP_FRAME    0xD1
+#define FLASH_LOG_END_FRAME     0xD2
+
+// End frame flags
+#define FLASH_LOG_DUMP_ABORTED  0x01 // A sector was erased during the dump
+
+void initFlashLog(void);
+void appendFlashLog(const TelemetryRecord* record);
+uint8_t pollFlashLog(void);
+void requestFlashLogDump(void);
+void listenFlashLogCommand(void);
+uint32_t getFlashLogDrops(void);
+
+#endif /* INC_FLASH_LOG_H_ */
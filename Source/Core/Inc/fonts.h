@@ -9,9 +9,27 @@
 
 
 /* Exported types ------------------------------------------------------------*/
+/* Font packed by Tools/font_pack.py (fonts_packed.c): per glyph only the bounding box of the set pixels,
+ * row by row. Read it a row at a time with font_glyph_row(). Cells are at most 16 pixels wide */
+typedef struct {
+	uint8_t chWidth;             /* cell size in pixels */
+	uint8_t chHeight;
+	uint8_t chFirst;             /* code of the first character */
+	uint8_t chCount;
+	const uint16_t *phwOffset;   /* start of each glyph in pchData */
+	const uint8_t *pchData;
+} font_packed_t;
+
 /* Exported constants --------------------------------------------------------*/
 /* Exported macro ------------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
+extern const font_packed_t c_tFont1206;
+extern const font_packed_t c_tFont1608;
+extern const font_packed_t c_tFont1612;
+extern const font_packed_t c_tFont3216;
+extern uint16_t font_glyph_row(const font_packed_t *ptFont, uint8_t chChr, uint8_t chRow);
+
+/* Source of the packed fonts above; nothing references them, so the linker drops them from flash */
 extern const uint8_t c_chFont1206[95][12];
 extern const uint8_t c_chFont1608[95][16];
 extern const uint8_t c_chFont1612[11][32];
@@ -18,11 +18,22 @@ typedef struct
   TIM_HandleTypeDef* timerHandle;
   uint32_t timerChannel;
   uint8_t isComplimentary; // 1 when timer channel is complimentary (i.e., TIMx_CHxN)
+  uint8_t isPwmMode2; // 1 when the channel runs in PWM mode 2 (active while CNT >= CCR)
   uint32_t clockFrequencyHz;
 } TimerParams;
 
+// Register values for one frequency and duty cycle, computed once by computePwmRegisters()
+typedef struct
+{
+  uint16_t prescaler; // TIMx_PSC
+  uint16_t period;    // TIMx_ARR
+  uint16_t pulse;     // TIMx_CCRx
+} PwmRegisters;
+
 void startPwmOutput(TimerParams* timParams);
 void stopPwmOutput(TimerParams* timParams);
 void updatePwmSignal(TimerParams* params, uint32_t freqHz, uint8_t dutyCycle);
+uint8_t computePwmRegisters(TimerParams* params, uint32_t freqHz, uint8_t dutyCycle, PwmRegisters* regs);
+void applyPwmRegisters(TimerParams* params, const PwmRegisters* regs);
 
 #endif /* INC_PWM_UTILS_H_ */
@@ -0,0 +1,24 @@
+/*******************************************************************************
+  * File Name          : range_graph.h
+  * Description        :
+  *    Scrolling strip chart of recent distances on the SSD1331 OLED display.
+  ******************************************************************************
+  */
+#ifndef INC_RANGE_GRAPH_H_
+#define INC_RANGE_GRAPH_H_
+
+#include <stdint.h>
+#include "ssd1331.h"
+
+#define RANGE_GRAPH_POS_Y     16   // Below the FONT_LARGE distance readout
+#define RANGE_GRAPH_HEIGHT    48   // Rows down to the bottom of the display
+#define RANGE_GRAPH_WIDTH     96   // One column per sample
+#define RANGE_GRAPH_MAX_M     5.0  // Distance at the top of the chart, larger ones are clipped
+
+void initRangeGraph(void);
+void addRangeGraphSample(double distance, enum Color colour);
+void addRangeGraphGap(void);
+void redrawRangeGraph(void);
+void addRangeGraphToBands(void);
+
+#endif /* INC_RANGE_GRAPH_H_ */
@@ -0,0 +1,59 @@
+/*******************************************************************************
+  * File Name          : scheduler.h
+  * Description        :
+  *    Run-to-completion scheduler. Each task is a handler which is called with
+  *    the events posted to it since its last run, does a short piece of work
+  *    and returns. Tasks run in the order they were added: after each handler
+  *    the scheduler starts again from the first task with events pending, so
+  *    a task which keeps posting events to itself starves the tasks added
+  *    after it and must be the last or only task.
+  *    When no task has events, the CPU sleeps in WFI until the next interrupt,
+  *    at the latest the 1 ms SysTick.
+  *
+  *    Events are bits of a 32-bit mask per task. Posting an event which is
+  *    still pending has no further effect, so data goes through the task's
+  *    own mailbox (see display_task.h) and the event only says that there is
+  *    something new. postEvent() can be called from interrupts.
+  *
+  *    Timers post events to a task once after a delay or periodically. They
+  *    are checked against HAL_GetTick() on every pass, so they resolve to 1 ms.
+  *
+  *    The time spent in each handler is measured with the DWT cycle counter.
+  *    reportSchedulerStats() logs, for each task, the runs, the share of the
+  *    CPU and the longest run since the previous report, then the share spent
+  *    sleeping and the rest, taken by interrupts and the scheduler itself.
+  ******************************************************************************
+  */
+#ifndef INC_SCHEDULER_H_
+#define INC_SCHEDULER_H_
+
+#include <stdint.h>
+
+#define SCHED_MAX_TASKS   8
+#define SCHED_MAX_TIMERS  8
+#define SCHED_NO_TASK     0xFF // Returned by addTask() when SCHED_MAX_TASKS are in use
+#define SCHED_NO_TIMER    0xFF // Returned by startTimer() when SCHED_MAX_TIMERS are running
+
+typedef uint8_t TaskId;
+typedef uint8_t TimerId;
+
+// Called with the events posted since the last run, never with 0
+typedef void (*TaskHandler)(uint32_t events);
+
+typedef struct
+{
+  const char* name;
+  uint32_t runs;        // Since the last report
+  uint32_t cycles;      // CPU cycles in the handler since the last report
+  uint32_t maxCycles;   // Longest run since the last report
+} TaskStats;
+
+TaskId addTask(const char* name, TaskHandler handler);
+void postEvent(TaskId task, uint32_t events);
+TimerId startTimer(TaskId task, uint32_t events, uint32_t delayMs, uint32_t periodMs);
+void stopTimer(TimerId timer);
+uint8_t getTaskStats(TaskId task, TaskStats* stats);
+void reportSchedulerStats(void);
+void runScheduler(void);
+
+#endif /* INC_SCHEDULER_H_ */
@@ -8,6 +8,6 @@
 #ifndef INC_SS_TWR_INITIATOR_H_
 #define INC_SS_TWR_INITIATOR_H_
 
-int ss_twr_initiator(void);
+void ss_twr_initiator(void);
 
 #endif /* INC_SS_TWR_INITIATOR_H_ */
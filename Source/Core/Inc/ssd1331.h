@@ -28,10 +28,39 @@
 #include <math.h>
 #include <stdlib.h>
 
+/* 1: all primitives draw into a 96x64 RAM framebuffer (12 KB, 6 KB in 8-bit colour) and ssd1331_flush()
+ *    sends the dirty rectangles; 0: every pixel is written to the display immediately */
+#define SSD1331_FRAMEBUFFER  1
+
+/* 1: ssd1331_flush() returns at once and the dirty rectangles are sent by SPI2 TX DMA (DMA1 Stream4)
+ *    from a second framebuffer (another 12 KB / 6 KB) while drawing continues; 0: blocking transfers.
+ *    Requires SSD1331_FRAMEBUFFER */
+#define SSD1331_USE_DMA      1
+
+/* 1: the application draws through the band renderer (ssd1331_band.c) rather than the primitives
+ *    below; set SSD1331_FRAMEBUFFER and SSD1331_USE_DMA to 0 with it to save their RAM */
+#define SSD1331_BAND_RENDERER 0
+
+#if (SSD1331_USE_DMA == 1) && (SSD1331_FRAMEBUFFER != 1)
+#error "SSD1331_USE_DMA requires SSD1331_FRAMEBUFFER"
+#endif
+
+/* 16: 65k colours, RGB565, 2 bytes per pixel on the bus and in the framebuffers
+ *  8: 256 colours, RGB332, 1 byte per pixel: half the flush time and framebuffer RAM */
+#define SSD1331_COLOUR_DEPTH 16
+
+#if (SSD1331_COLOUR_DEPTH != 16) && (SSD1331_COLOUR_DEPTH != 8)
+#error "SSD1331_COLOUR_DEPTH must be 16 or 8"
+#endif
+
 #define FONT_1206    12
 #define FONT_1608    16
 
+#if (SSD1331_COLOUR_DEPTH == 16)
 #define RGB(R,G,B)  (((R >> 3) << 11) | ((G >> 2) << 5) | (B >> 3))
+#else
+#define RGB(R,G,B)  (((R >> 5) << 5) | ((G >> 5) << 2) | (B >> 6))
+#endif
 enum Color{
     BLACK     = RGB(  0,  0,  0), // black
     GREY      = RGB(192,192,192), // grey
@@ -50,7 +79,20 @@ enum Color{
 
 
 /* Exported types ------------------------------------------------------------*/
+/* Pixels in bus order: RGB565 is byte swapped (high byte first in memory) so rows can be streamed as they are */
+#if (SSD1331_COLOUR_DEPTH == 16)
+typedef uint16_t ssd1331_pixel_t;
+#define __SSD1331_PIXEL(__HW)   ((uint16_t)(((__HW) >> 8) | ((__HW) << 8)))
+#else
+typedef uint8_t ssd1331_pixel_t;
+#define __SSD1331_PIXEL(__HW)   ((uint8_t)(__HW))
+#endif
+
 /* Exported constants --------------------------------------------------------*/
+#define OLED_WIDTH      96
+#define OLED_HEIGHT     64
+#define SSD1331_BPP     sizeof(ssd1331_pixel_t)
+
 /* Exported macro ------------------------------------------------------------*/                    
 
 /* Exported functions ------------------------------------------------------- */
@@ -60,6 +102,7 @@ extern void ssd1331_draw_v_line(uint8_t chXpos, uint8_t chYpos, uint8_t chHeight
 extern void ssd1331_draw_h_line(uint8_t chXpos, uint8_t chYpos, uint8_t chWidth, uint16_t hwColor);
 extern void ssd1331_draw_rect(uint8_t chXpos, uint8_t chYpos, uint8_t chWidth, uint8_t chHeight, uint16_t hwColor);
 extern void ssd1331_fill_rect(uint8_t chXpos, uint8_t chYpos, uint8_t chWidth, uint8_t chHeight, uint16_t hwColor);
+extern void ssd1331_copy_window(uint8_t chX0, uint8_t chY0, uint8_t chX1, uint8_t chY1, uint8_t chXdst, uint8_t chYdst);
 extern void ssd1331_draw_circle(uint8_t chXpos, uint8_t chYpos, uint8_t chRadius, uint16_t hwColor);
 extern void ssd1331_display_char(uint8_t chXpos, uint8_t chYpos, uint8_t chChr, uint8_t chSize, uint16_t hwColor);
 extern void ssd1331_display_num(uint8_t chXpos, uint8_t chYpos, uint32_t chNum, uint8_t chLen, uint8_t chSize, uint16_t hwColor);
@@ -68,6 +111,11 @@ extern void ssd1331_draw_1616char(uint8_t chXpos, uint8_t chYpos, uint8_t chChar
 extern void ssd1331_draw_3216char(uint8_t chXpos, uint8_t chYpos, uint8_t chChar, uint16_t hwColor);
 extern void ssd1331_draw_bitmap(uint8_t chXpos, uint8_t chYpos, const uint8_t *pchBmp, uint8_t chWidth, uint8_t chHeight, uint16_t hwColor);
 extern void ssd1331_clear_screen(uint16_t hwColor);
+extern void ssd1331_flush(void);
+extern void ssd1331_expand_glyph_row(ssd1331_pixel_t *ptDst, uint16_t hwBits, uint8_t chWidth, ssd1331_pixel_t tFore);
+extern void ssd1331_write_window(uint8_t chX0, uint8_t chY0, uint8_t chX1, uint8_t chY1, const void *pData, uint16_t hwLen);
+extern uint8_t ssd1331_is_busy(void);
+extern void ssd1331_flush_cplt_callback(void);
 
 extern void ssd1331_init(void);
 
@@ -0,0 +1,32 @@
+/**
+  ******************************************************************************
+  * @file    ssd1331_band.h
+  * @brief   Band renderer for the SSD1331: retained display list rasterised in
+  *          horizontal bands through a small line buffer
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _SSD1331_BAND_H_
+#define _SSD1331_BAND_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "ssd1331.h"
+
+#define SSD1331_BAND_ROWS       8     /* rows per band, must divide OLED_HEIGHT */
+#define SSD1331_BAND_MAX_CMDS   12    /* display list entries */
+#define SSD1331_BAND_TEXT_LEN   12    /* characters kept per text entry (a full FONT_1608 row) */
+
+/* Exported functions ------------------------------------------------------- */
+extern void ssd1331_band_clear(uint16_t hwBackground);
+extern uint8_t ssd1331_band_fill_rect(uint8_t chXpos, uint8_t chYpos, uint8_t chWidth, uint8_t chHeight, uint16_t hwColor);
+extern uint8_t ssd1331_band_line(uint8_t chXpos0, uint8_t chYpos0, uint8_t chXpos1, uint8_t chYpos1, uint16_t hwColor);
+extern uint8_t ssd1331_band_text(uint8_t chXpos, uint8_t chYpos, const char *pchString, uint8_t chSize, uint16_t hwColor);
+extern uint8_t ssd1331_band_plot(uint8_t chXpos, uint8_t chYpos, uint8_t chHeight, const uint8_t *pchRows,
+                                 const uint16_t *phwColors, uint8_t chCount, uint8_t chFirst);
+extern void ssd1331_band_render(void);
+extern void ssd1331_band_invalidate(void);
+
+#endif
+/*-------------------------------END OF FILE-------------------------------*/
@@ -0,0 +1,89 @@
+/*******************************************************************************
+  * File Name          : telemetry.h
+  * Description        :
+  *    Streams one compact binary record per ranging exchange over USART2,
+  *    COBS framed and CRC protected. Tools/uwb_decoder decodes the stream.
+  *
+  *    Frame on the wire: 0x00, COBS(record, CRC), 0x00. The leading zero
+  *    keeps printf text written between two frames out of the next frame.
+  *
+  *    Record, version 1, little endian, 26 bytes, followed by a CRC-16/CCITT
+  *    (poly 0x1021, init 0xFFFF) of the record, low byte first:
+  *      offset  size  field
+  *       0      1     version       TELEMETRY_VERSION
+  *       1      1     flags         TLM_FLAG_* below
+  *       2      2     sequence      Record counter, gaps mean lost records
+  *       4      4     timestampMs   HAL_GetTick() at the end of the exchange
+  *       8      4     rangeMm       Signed distance in mm, 0 without TLM_FLAG_RANGE_VALID
+  *      12      2     clockOffset   Carrier integrator, ratio = clockOffset / 2^26
+  *      14      2     fpIndex       Ipatov first path index, 10.6 fixed point
+  *      16      4     cirPeak       Ipatov CIR peak: index [30:21], amplitude [20:0]
+  *      20      4     cirPower      Ipatov channel area
+  *      24      2     accumCount    Ipatov accumulated preamble symbols
+  *    A new version may only append fields; decoders read the fields they know.
+  *    Versions stop at 0x7F, frames starting with 0x80 to 0xFF carry other
+  *    data: 0xC1 is a CIR dump, see cir_capture.h, 0xD1 and 0xD2 are a flash
+  *    log dump, see flash_log.h, and 0xF0 is a tokenised log message, see
+  *    tlog.h.
+  ******************************************************************************
+  */
+#ifndef INC_TELEMETRY_H_
+#define INC_TELEMETRY_H_
+
+#include <stdint.h>
+
+#define TELEMETRY_ENABLE  1 // 0: no records are sent and no diagnostics are read
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_MAX_PAYLOAD 32 // Bytes of a frame before the CRC and COBS encoding
+#define TELEMETRY_MAX_FRAME_PAYLOAD 250 // The same for buildTelemetryFrame(), a frame is at most 255 bytes
+#define TELEMETRY_FRAME_OVERHEAD 5 // Delimiter, CRC, COBS overhead byte, delimiter
+
+// Record flags
+#define TLM_FLAG_RANGE_VALID  0x01 // rangeMm holds a distance
+#define TLM_FLAG_RX_TIMEOUT   0x02 // No response before the RX timeout
+#define TLM_FLAG_RX_ERROR     0x04 // Response lost to a PHY header, CRC or SFD error
+#define TLM_FLAG_BAD_FRAME    0x08 // A good frame was received, but not the expected response
+#define TLM_FLAG_DIAG_VALID   0x10 // fpIndex, cirPeak, cirPower and accumCount are valid
+#define TLM_FLAG_LOG_DROPPED  0x20 // Output was dropped since the previous record, see port_tx_dropped()
+
+typedef struct
+{
+  uint8_t flags;
+  int32_t rangeMm;
+  int16_t clockOffset;
+  uint16_t fpIndex;
+  uint32_t cirPeak;
+  uint32_t cirPower;
+  uint16_t accumCount;
+} TelemetryRecord;
+
+void sendTelemetry(TelemetryRecord* record);
+void sendTelemetryFrame(const uint8_t* payload, uint8_t length);
+uint8_t buildTelemetryFrame(uint8_t* payload, uint8_t length, uint8_t* frame);
+uint16_t encodeTelemetryCobs(uint8_t* dst, const uint8_t* src, uint16_t length);
+uint16_t computeTelemetryCrc(const uint8_t* data, uint16_t length);
+
+// Little endian fields of the frames
+static inline void putLe16(uint8_t* dst, uint16_t value)
+{
+  dst[0] = value;
+  dst[1] = value >> 8;
+}
+
+static inline void putLe32(uint8_t* dst, uint32_t value)
+{
+  putLe16(dst, value);
+  putLe16(dst + 2, value >> 16);
+}
+
+static inline uint16_t getLe16(const uint8_t* src)
+{
+  return src[0] | (src[1] << 8);
+}
+
+static inline uint32_t getLe32(const uint8_t* src)
+{
+  return getLe16(src) | ((uint32_t)getLe16(src + 2) << 16);
+}
+
+#endif /* INC_TELEMETRY_H_ */
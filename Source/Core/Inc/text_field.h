@@ -0,0 +1,38 @@
+/*******************************************************************************
+  * File Name          : text_field.h
+  * Description        :
+  *    A fixed size text field on the SSD1331 OLED display that only redraws the
+  *    character cells that changed since the last update.
+  ******************************************************************************
+  */
+#ifndef INC_TEXT_FIELD_H_
+#define INC_TEXT_FIELD_H_
+
+#include <stdint.h>
+#include "oled_utils.h"
+
+#define TEXT_FIELD_MAX_CHARS 12 // 96 px wide display / 8 px wide FONT_LARGE cell
+
+typedef enum
+{
+  ALIGN_LEFT = 0,
+  ALIGN_RIGHT
+} TextAlign;
+
+// Structure to store a text field and what is currently shown in it
+typedef struct
+{
+  uint8_t posX;                           // Left edge of the first cell
+  uint8_t posY;                           // Top edge of the cells
+  uint8_t numOfCells;                     // Width of the field in characters
+  FontSize fontSize;
+  TextAlign align;                        // Where shorter text is placed in the field
+  enum Color colour;                      // Colour of the text on display
+  char cells[TEXT_FIELD_MAX_CHARS + 1];   // Text on display, padded with spaces
+} TextField;
+
+void initTextField(TextField* field, uint8_t numOfCells, FontSize fontSize, TextAlign align, Corner corner);
+void updateTextField(TextField* field, const char* text, enum Color txtColour);
+void clearTextField(TextField* field);
+
+#endif /* INC_TEXT_FIELD_H_ */
@@ -0,0 +1,91 @@
+/*******************************************************************************
+  * File Name          : tlog.h
+  * Description        :
+  *    Tokenised logging. TLOG("format", args...) sends a 16-bit token of the
+  *    format string and the raw arguments; the text is only put together on
+  *    the host by Tools/tlog_decode.py.
+  *
+  *    Each format string is placed in the .tlog_fmt section. The linker
+  *    scripts keep that section in the ELF file but do not load it, so the
+  *    strings take no flash. The address of a string in the section is its
+  *    token, and tlog_decode.py reads the dictionary from the ELF file.
+  *
+  *    Each argument is sent as one 32-bit word: integers and characters as
+  *    they are, float and double as a float, and pointers (%s) as an address,
+  *    which the host resolves for strings in flash. At most 6 arguments.
+  *    Format strings have no line ending, the host adds it.
+  *
+  *    Frame payload: 0xF0, token (2 bytes), arguments (4 bytes each), all
+  *    little endian, framed like the telemetry records (see telemetry.h).
+  ******************************************************************************
+  */
+#ifndef INC_TLOG_H_
+#define INC_TLOG_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define TLOG_ENABLE     1    // 0: TLOG() falls back to printf(), for a plain serial terminal
+#define TLOG_FRAME_TYPE 0xF0 // First payload byte of a log frame
+#define TLOG_MAX_ARGS   6
+
+#if (TLOG_ENABLE == 1)
+
+#define TLOG(fmt, ...)                                                                      \
+  do                                                                                        \
+  {                                                                                         \
+    static const char tlogFormat[] __attribute__((section(".tlog_fmt"), used)) = fmt;      \
+    const uint32_t tlogArgs[] = { 0, TLOG_ARGS(__VA_ARGS__) };                              \
+    sendLog((uint16_t)(uintptr_t)tlogFormat, &tlogArgs[1], sizeof(tlogArgs) / sizeof(uint32_t) - 1); \
+  } while (0)
+
+#else
+
+#include <stdio.h>
+#define TLOG(fmt, ...) printf(fmt "\r\n", ##__VA_ARGS__)
+
+#endif
+
+// Converts one argument to its 32-bit word
+#define TLOG_ARG(x) _Generic((x),      \
+    float: tlogFloatWord,               \
+    double: tlogFloatWord,              \
+    char*: tlogPointerWord,             \
+    const char*: tlogPointerWord,       \
+    default: tlogIntWord)(x)
+
+// TLOG_ARGS(a, b, ...) expands to TLOG_ARG(a), TLOG_ARG(b), ...
+#define TLOG_NARGS(...) TLOG_NARGS_(0, ##__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0)
+#define TLOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, N, ...) N
+#define TLOG_CAT(a, b) TLOG_CAT_(a, b)
+#define TLOG_CAT_(a, b) a##b
+#define TLOG_ARGS(...) TLOG_CAT(TLOG_ARGS_, TLOG_NARGS(__VA_ARGS__))(__VA_ARGS__)
+#define TLOG_ARGS_0()
+#define TLOG_ARGS_1(a) TLOG_ARG(a)
+#define TLOG_ARGS_2(a, ...) TLOG_ARG(a), TLOG_ARGS_1(__VA_ARGS__)
+#define TLOG_ARGS_3(a, ...) TLOG_ARG(a), TLOG_ARGS_2(__VA_ARGS__)
+#define TLOG_ARGS_4(a, ...) TLOG_ARG(a), TLOG_ARGS_3(__VA_ARGS__)
+#define TLOG_ARGS_5(a, ...) TLOG_ARG(a), TLOG_ARGS_4(__VA_ARGS__)
+#define TLOG_ARGS_6(a, ...) TLOG_ARG(a), TLOG_ARGS_5(__VA_ARGS__)
+
+static inline uint32_t tlogIntWord(uint32_t value)
+{
+  return value;
+}
+
+static inline uint32_t tlogFloatWord(float value)
+{
+  uint32_t word;
+
+  memcpy(&word, &value, sizeof(word));
+  return word;
+}
+
+static inline uint32_t tlogPointerWord(const void* pointer)
+{
+  return (uint32_t)(uintptr_t)pointer;
+}
+
+void sendLog(uint16_t token, const uint32_t* args, uint8_t numOfArgs);
+
+#endif /* INC_TLOG_H_ */
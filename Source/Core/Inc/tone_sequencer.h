@@ -0,0 +1,44 @@
+/*******************************************************************************
+  * File Name          : tone_sequencer.h
+  * Description        :
+  *    Plays looping sequences of (frequency, duration) steps on the buzzer
+  *    with TIM1 DMA burst updates, without CPU involvement.
+  ******************************************************************************
+  */
+#ifndef INC_TONE_SEQUENCER_H_
+#define INC_TONE_SEQUENCER_H_
+
+#include <stdint.h>
+#include "buzzer.h"
+
+#define TONE_SEQ_MAX_BURSTS 32 // Timer updates per sequence; a step longer than 256 tone periods takes more than one
+
+// One step of a sequence as given by the user
+typedef struct
+{
+  uint16_t freqHz;     // 0 for silence
+  uint16_t durationMs;
+} ToneStep;
+
+// Register values loaded by one DMA burst, in TIM1 register order from TIMx_ARR
+typedef struct
+{
+  uint16_t period;      // TIMx_ARR
+  uint16_t repetitions; // TIMx_RCR: the step lasts repetitions + 1 tone periods
+  uint16_t unused[3];   // TIMx_CCR1..3
+  uint16_t pulse;       // TIMx_CCR4 (buzzer channel)
+} ToneBurst;
+
+// Sequence compiled by compileToneSequence(). The first step is stored last, see tone_sequencer.c
+typedef struct
+{
+  ToneBurst bursts[TONE_SEQ_MAX_BURSTS];
+  uint8_t numOfBursts;
+} ToneSequence;
+
+uint8_t compileToneSequence(const ToneStep* steps, uint8_t numOfSteps, BuzzerVolume volume, ToneSequence* sequence);
+void playToneSequence(const ToneSequence* sequence);
+void stopToneSequence(void);
+uint8_t isToneSequencePlaying(void);
+
+#endif /* INC_TONE_SEQUENCER_H_ */
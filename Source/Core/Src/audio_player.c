@@ -3,80 +3,130 @@
  *
  *  Created on: 12 Aug 2022
  *      Author: auabe
+ *
+ *  The beep cadence is generated by the timers (see startBuzzerCadence()),
+ *  so no interrupts are involved while playing. The cadence is only
+ *  reprogrammed when the beep interval changes.
+ *
+ *  Close to the target the cadence gives way to multi-tone alert sequences
+ *  played by the tone sequencer, which switches between them at the end of
+ *  a loop.
  */
 #include <audio_player.h>
 #include "buzzer.h"
-#include "tim.h"
-#include <stdio.h>
+#include "tone_sequencer.h"
+#include "tlog.h"
+
+#define BUZZER_TONE         TONE_500_HZ
+#define BEEP_ON_MS          100 // 50 tone periods
+#define BEEP_OFF_MS_PER_M   200 // 100 tone periods per metre
+#define BEEP_OFF_STEP_MS    10  // Interval resolution; smaller changes are not reprogrammed
+#define BEEP_OFF_MIN_MS     BEEP_OFF_STEP_MS
+#define NEAR_ALERT_M        0.5 // Rising chirps below this distance
+#define CLOSE_ALERT_M       0.2 // Fast high double beeps below this distance
+
+typedef enum
+{
+  AUDIO_PAUSED,
+  AUDIO_CADENCE,
+  AUDIO_SEQUENCE
+} AudioMode;
 
-#define BUZZER_FREQ_HZ   500
-#define BEEP_MULTIPLIER  100
+static const ToneStep nearAlertSteps[] = {
+  { 1000, 40 }, { 1250, 40 }, { 1500, 40 }, { 1750, 40 }, { 2000, 40 }, { 0, 150 }
+};
+static const ToneStep closeAlertSteps[] = {
+  { 3000, 50 }, { 0, 30 }, { 3000, 50 }, { 0, 70 }
+};
 
-static uint32_t itrs = 0;
-static uint32_t onItrs = 50;
-static uint32_t offItrs = 0;
+static ToneSequence nearAlert;
+static ToneSequence closeAlert;
+
+static uint32_t offMs = 0;
 
 static uint8_t initialized = 0;
-static uint8_t isOn = 1;
-static uint8_t isPaused = 0;
+static AudioMode mode = AUDIO_PAUSED;
 
-void playAudio(double distance)
+// FUNCTION      : initAudio
+// DESCRIPTION   :
+//    Starts the buzzer and compiles the alert sequences on the first call.
+// PARAMETERS    : None
+// RETURNS       : None
+static void initAudio(void)
 {
-  offItrs = distance * BEEP_MULTIPLIER;
+  TLOG("buzzerOn");
+  buzzerOn(BUZZER_TONE);
 
-  if (!initialized)
-  {
-    printf("buzzerOn\r\n");
-    buzzerOn(BUZZER_FREQ_HZ);
-    muteBuzzer(); // Playback will be handled in the interrupt callback
+  compileToneSequence(nearAlertSteps, sizeof(nearAlertSteps) / sizeof(ToneStep), VOLUME_HIGH, &nearAlert);
+  compileToneSequence(closeAlertSteps, sizeof(closeAlertSteps) / sizeof(ToneStep), VOLUME_HIGH, &closeAlert);
 
-    initialized = 1;
-  }
-
-  isPaused = 0;
+  initialized = 1;
 }
 
-void pauseAudio(void)
+// FUNCTION      : playCadence
+// DESCRIPTION   :
+//    Beeps with an interval proportional to the distance.
+// PARAMETERS    :
+//    double distance : Distance in metres.
+// RETURNS       : None
+static void playCadence(double distance)
 {
-  isPaused = 1;
-  itrs = 0;
-}
+  uint32_t newOffMs = (distance > 0.0) ? (uint32_t)(distance * BEEP_OFF_MS_PER_M) : 0;
 
-void HAL_TIM_PWM_PulseFinishedCallback(TIM_HandleTypeDef *htim)
-{
-  if (isPaused == 1)
+  newOffMs -= newOffMs % BEEP_OFF_STEP_MS;
+  if (newOffMs < BEEP_OFF_MIN_MS)
   {
-    muteBuzzer();
-    return;
+    // A new beep must not be triggered before the previous one has finished
+    newOffMs = BEEP_OFF_MIN_MS;
   }
 
-  if (itrs > onItrs && itrs > offItrs)
+  if (mode == AUDIO_SEQUENCE)
   {
-    isOn = 1;
-    itrs = 0;
-    return;
+    stopToneSequence();
+    mode = AUDIO_PAUSED;
   }
 
-  if (isOn == 1 && itrs < onItrs)
+  if (mode == AUDIO_PAUSED)
   {
-    unMuteBuzzer();
-//    printf("ON: itrs: %ld\r\n", itrs);
+    startBuzzerCadence(BEEP_ON_MS, newOffMs);
+    mode = AUDIO_CADENCE;
   }
-  else if (isOn == 1 && itrs == onItrs)
+  else if (newOffMs != offMs)
   {
-    isOn = 0;
-    itrs = 0;
+    updateBuzzerCadence(BEEP_ON_MS, newOffMs);
   }
-  else if (isOn == 0 && itrs < offItrs)
+
+  offMs = newOffMs;
+}
+
+void playAudio(double distance)
+{
+  if (!initialized)
+  {
+    initAudio();
+  }
+
+  if (distance >= NEAR_ALERT_M)
+  {
+    playCadence(distance);
+    return;
+  }
+
+  // Does not block; an alert already playing finishes its loop first
+  playToneSequence((distance < CLOSE_ALERT_M) ? &closeAlert : &nearAlert);
+  mode = AUDIO_SEQUENCE;
+}
+
+void pauseAudio(void)
+{
+  if (mode == AUDIO_CADENCE)
   {
-    muteBuzzer();
-//    printf("OFF: itrs: %ld\r\n", itrs);
+    stopBuzzerCadence();
   }
-  else if (isOn == 0  && itrs == offItrs)
+  else if (mode == AUDIO_SEQUENCE)
   {
-    isOn = 1;
-    itrs = 0;
+    stopToneSequence();
   }
 
-  itrs++;
+  mode = AUDIO_PAUSED;
 }
@@ -9,12 +9,14 @@
 #include "buzzer.h"
 #include "pwm_utils.h"
 #include "tim.h"
-#include <stdio.h>
+#include "tlog.h"
 
 // Private definitions
-#define TONE_DUTY_CYCLE         50
 #define BUZZER_CHANNEL          TIM_CHANNEL_4
 #define BUZZER_CH_COMPLIMENT    0
+#define BUZZER_PWM_MODE_2       1   // See sConfigOC.OCMode in MX_TIM1_Init()
+#define CADENCE_TICKS_PER_MS    10  // TIM2 counts at 10 kHz (84 MHz / 8400, see MX_TIM2_Init())
+#define MAX_BEEP_PERIODS        256 // TIM1 repetition counter is 8 bits
 
 void coldStart(void);
 
@@ -22,39 +24,67 @@ static TimerParams buzzerParams = { 0 };
 
 static uint8_t isInitialized = 0;
 
-static uint16_t _freqHz = 100;
+// Frequency of each BuzzerTone and duty cycle of each BuzzerVolume
+static const uint16_t toneFreqsHz[NUM_OF_TONES] = { 250, 500, 1000, 2000, 4000 };
+static const uint8_t volumeDutyCycles[NUM_OF_VOLUMES] = { 0, 10, 25, 50 };
+
+// Timer register values of every tone and volume, computed once by initBuzzer()
+static PwmRegisters pwmTable[NUM_OF_TONES][NUM_OF_VOLUMES];
+
+static BuzzerTone currentTone = TONE_500_HZ;
+static BuzzerVolume currentVolume = VOLUME_HIGH;
 
 // FUNCTION      : initBuzzer
 // DESCRIPTION   :
-//    Initialize the buzzer by initializing timer parameters. It is mandatory
+//    Initialize the buzzer by initializing timer parameters and precomputing
+//    the timer register values of every tone and volume. It is mandatory
 //    to call this function before using other functions in this file.
 // PARAMETERS    : None
 // RETURNS       : None
 void initBuzzer(void)
 {
+  uint8_t tone;
+  uint8_t volume;
+
   buzzerParams.timerHandle = &htim1;
   buzzerParams.timerChannel = BUZZER_CHANNEL;
   buzzerParams.isComplimentary = BUZZER_CH_COMPLIMENT;
+  buzzerParams.isPwmMode2 = BUZZER_PWM_MODE_2;
   buzzerParams.clockFrequencyHz = HAL_RCC_GetPCLK2Freq();
 
+  for (tone = 0; tone < NUM_OF_TONES; tone++)
+  {
+    for (volume = 0; volume < NUM_OF_VOLUMES; volume++)
+    {
+      if (!computePwmRegisters(&buzzerParams, toneFreqsHz[tone], volumeDutyCycles[volume], &pwmTable[tone][volume]))
+      {
+        TLOG("[buzzer::initBuzzer] Error! Unsupported tone %u Hz.", toneFreqsHz[tone]);
+        return;
+      }
+    }
+  }
+
   isInitialized = 1;
 }
 
 // FUNCTION      : buzzerOn
-// DESCRIPTION   : Sound the buzzer with a desired frequency.
+// DESCRIPTION   :
+//    Sets up the buzzer output with a desired tone. TIM1 runs in one-pulse
+//    mode triggered by TIM2, so the buzzer only sounds during the beeps of
+//    startBuzzerCadence().
 // PARAMETERS    :
-//    uint16_t freqHz : Ringing frequency in Hertz.
+//    BuzzerTone tone : Ringing tone.
 // RETURNS       : None
-void buzzerOn(uint16_t freqHz)
+void buzzerOn(BuzzerTone tone)
 {
   if(!isInitialized)
   {
-    printf("[buzzer::buzzerOn] Error! Buzzer is not initialized.\r\n");
+    TLOG("[buzzer::buzzerOn] Error! Buzzer is not initialized.");
     return;
   }
 
   startPwmOutput(&buzzerParams);
-  updateBuzzerFrequency(freqHz);
+  setBuzzerTone(tone);
 }
 
 // FUNCTION      : buzzerOff
@@ -65,50 +95,196 @@ void buzzerOff(void)
 {
   if(!isInitialized)
   {
-    printf("[buzzer::buzzerOff] Error! Buzzer is not initialized.\r\n");
+    TLOG("[buzzer::buzzerOff] Error! Buzzer is not initialized.");
     return;
   }
 
   stopPwmOutput(&buzzerParams);
 }
 
-// FUNCTION      : updateBuzzerFrequency
-// DESCRIPTION   : Update the buzzer frequency on the fly.
+// FUNCTION      : setBuzzerTone
+// DESCRIPTION   :
+//    Changes the tone on the fly with a table lookup: TIMx_ARR and TIMx_CCRx
+//    writes, and no arithmetic. Safe to call from interrupt context.
 // PARAMETERS    :
-//    uint16_t freqHz : New frequency in Hertz.
+//    BuzzerTone tone : New tone.
 // RETURNS       : None
-void updateBuzzerFrequency(uint16_t freqHz)
+void setBuzzerTone(BuzzerTone tone)
 {
-  if(!isInitialized)
+  if (!isInitialized || tone >= NUM_OF_TONES)
+  {
+    return;
+  }
+
+  currentTone = tone;
+  applyPwmRegisters(&buzzerParams, &pwmTable[currentTone][currentVolume]);
+}
+
+// FUNCTION      : setBuzzerVolume
+// DESCRIPTION   :
+//    Changes the duty cycle of the current tone: a single TIMx_CCRx write.
+//    Safe to call from interrupt context.
+// PARAMETERS    :
+//    BuzzerVolume volume : New volume. VOLUME_MUTE is kept for muteBuzzer().
+// RETURNS       : None
+void setBuzzerVolume(BuzzerVolume volume)
+{
+  if (!isInitialized || volume >= NUM_OF_VOLUMES)
+  {
+    return;
+  }
+
+  currentVolume = volume;
+  applyPwmRegisters(&buzzerParams, &pwmTable[currentTone][currentVolume]);
+}
+
+// FUNCTION      : applyBuzzerSettings
+// DESCRIPTION   :
+//    Writes the current tone and volume to the timer again, after something
+//    else (e.g. the tone sequencer) has changed its registers.
+// PARAMETERS    : None
+// RETURNS       : None
+void applyBuzzerSettings(void)
+{
+  if (!isInitialized)
   {
-    printf("[buzzer::updateBuzzerFrequency] Error! Buzzer is not initialized.\r\n");
     return;
   }
 
-  _freqHz = freqHz;
+  applyPwmRegisters(&buzzerParams, &pwmTable[currentTone][currentVolume]);
+}
 
-  // Dynamically update the frequency and the duty cycle of the PWM signal
-  updatePwmSignal(&buzzerParams, _freqHz, TONE_DUTY_CYCLE);
+// FUNCTION      : computeBuzzerRegisters
+// DESCRIPTION   :
+//    Computes the timer register values of any frequency on the buzzer timer,
+//    for tones outside the precomputed table. All results share one prescaler.
+// PARAMETERS    :
+//    uint16_t freqHz     : Frequency in Hertz.
+//    BuzzerVolume volume : Volume (duty cycle).
+//    PwmRegisters* regs  : Computed register values.
+// RETURNS       :
+//    uint8_t : 1 on success, 0 if the parameters are invalid.
+uint8_t computeBuzzerRegisters(uint16_t freqHz, BuzzerVolume volume, PwmRegisters* regs)
+{
+  if (!isInitialized || volume >= NUM_OF_VOLUMES)
+  {
+    TLOG("[buzzer::computeBuzzerRegisters] Error! Buzzer is not initialized or invalid volume.");
+    return 0;
+  }
+
+  return computePwmRegisters(&buzzerParams, freqHz, volumeDutyCycles[volume], regs);
 }
 
+// FUNCTION      : muteBuzzer
+// DESCRIPTION   :
+//    Silences the tone with a single TIMx_CCRx write, keeping the volume for
+//    unMuteBuzzer(). Safe to call from interrupt context.
+// PARAMETERS    : None
+// RETURNS       : None
 void muteBuzzer()
 {
-  if(!isInitialized)
+  if (!isInitialized)
   {
-    printf("[buzzer::muteBuzzer] Error! Buzzer is not initialized.\r\n");
     return;
   }
 
-  updatePwmSignal(&buzzerParams, _freqHz, 0);
+  applyPwmRegisters(&buzzerParams, &pwmTable[currentTone][VOLUME_MUTE]);
 }
 
+// FUNCTION      : unMuteBuzzer
+// DESCRIPTION   :
+//    Restores the volume after muteBuzzer() with a single TIMx_CCRx write.
+//    Safe to call from interrupt context.
+// PARAMETERS    : None
+// RETURNS       : None
 void unMuteBuzzer()
 {
+  if (!isInitialized)
+  {
+    return;
+  }
+
+  applyPwmRegisters(&buzzerParams, &pwmTable[currentTone][currentVolume]);
+}
+
+// FUNCTION      : startBuzzerCadence
+// DESCRIPTION   :
+//    Beeps the buzzer repeatedly without any interrupts. TIM2 generates the
+//    cadence and restarts TIM1 through its TRGO at the start of every beep.
+//    TIM1 then plays the beep length worth of tone periods, counted by its
+//    repetition counter, and stops by itself with the output low.
+//    Call buzzerOn() first.
+// PARAMETERS    :
+//    uint16_t onMs  : Length of each beep in milliseconds, at most 256 tone periods.
+//    uint32_t offMs : Silence between beeps in milliseconds.
+// RETURNS       : None
+void startBuzzerCadence(uint16_t onMs, uint32_t offMs)
+{
+  uint32_t periods = (uint32_t)onMs * toneFreqsHz[currentTone] / 1000;
+
   if(!isInitialized)
   {
-    printf("[buzzer::unMuteBuzzer] Error! Buzzer is not initialized.\r\n");
+    TLOG("[buzzer::startBuzzerCadence] Error! Buzzer is not initialized.");
     return;
   }
 
-  updatePwmSignal(&buzzerParams, _freqHz, TONE_DUTY_CYCLE);
+  if (periods == 0)
+  {
+    periods = 1;
+  }
+  else if (periods > MAX_BEEP_PERIODS)
+  {
+    periods = MAX_BEEP_PERIODS;
+  }
+
+  // The repetition counter is preloaded; the update event loads it and resets the counter
+  buzzerParams.timerHandle->Instance->RCR = periods - 1;
+  buzzerParams.timerHandle->Instance->EGR = TIM_EGR_UG;
+
+  // The update event of TIM2 is its TRGO, so the first beep starts at once
+  __HAL_TIM_SET_AUTORELOAD(&htim2, (onMs + offMs) * CADENCE_TICKS_PER_MS - 1);
+  __HAL_TIM_SET_COUNTER(&htim2, 0);
+  htim2.Instance->EGR = TIM_EGR_UG;
+  HAL_TIM_Base_Start(&htim2);
+}
+
+// FUNCTION      : updateBuzzerCadence
+// DESCRIPTION   :
+//    Changes the silence between beeps of a running cadence. TIM2 preloads its
+//    period, so the change takes effect from the next beep and the current
+//    one is not cut short.
+// PARAMETERS    :
+//    uint16_t onMs  : Length of each beep in milliseconds, as given to startBuzzerCadence().
+//    uint32_t offMs : New silence between beeps in milliseconds.
+// RETURNS       : None
+void updateBuzzerCadence(uint16_t onMs, uint32_t offMs)
+{
+  if(!isInitialized)
+  {
+    TLOG("[buzzer::updateBuzzerCadence] Error! Buzzer is not initialized.");
+    return;
+  }
+
+  __HAL_TIM_SET_AUTORELOAD(&htim2, (onMs + offMs) * CADENCE_TICKS_PER_MS - 1);
+}
+
+// FUNCTION      : stopBuzzerCadence
+// DESCRIPTION   :
+//    Stops the cadence and cuts a beep in progress short.
+// PARAMETERS    : None
+// RETURNS       : None
+void stopBuzzerCadence(void)
+{
+  if(!isInitialized)
+  {
+    TLOG("[buzzer::stopBuzzerCadence] Error! Buzzer is not initialized.");
+    return;
+  }
+
+  HAL_TIM_Base_Stop(&htim2);
+
+  // __HAL_TIM_DISABLE() leaves the counter running while a channel is enabled.
+  // With the counter back at 0 the PWM mode 2 output is low.
+  buzzerParams.timerHandle->Instance->CR1 &= ~TIM_CR1_CEN;
+  __HAL_TIM_SET_COUNTER(buzzerParams.timerHandle, 0);
 }
@@ -0,0 +1,220 @@
+/*******************************************************************************
+  * File Name          : cir_capture.c
+  * Description        :
+  *    Channel impulse response dumps, see cir_capture.h.
+  *
+  *    A dump is built in place in its capture buffer: the samples are read
+  *    from the accumulator right behind the header, the CRC is appended and
+  *    the whole dump is COBS encoded towards the start of the buffer. The
+  *    frame is then handed to port_tx_block(), which sends it without a copy.
+  *
+  *    A window dump is a 418-byte frame, 4.5 ms at 921600 baud. A full dump
+  *    is a frame of up to 6153 bytes, 67 ms, so when ranging fast only one in
+  *    a few exchanges gets a buffer; the others are dropped and counted.
+  ******************************************************************************
+  */
+#include "cir_capture.h"
+#include "telemetry.h"
+#include "main.h"
+#include <port.h>
+
+#if (CIR_CAPTURE_ENABLE == 1)
+
+// Private defines
+#define HEADER_LENGTH 28
+#define CRC_LENGTH    2
+#define MAX_DUMP_LENGTH (HEADER_LENGTH + CIR_IPATOV_SAMPLES * CIR_SAMPLE_BYTES + CRC_LENGTH)
+#define COBS_OVERHEAD (MAX_DUMP_LENGTH / 254 + 1)
+// Delimiter and room for the COBS overhead, so the encoder never overtakes its input
+#define DUMP_OFFSET   (1 + COBS_OVERHEAD)
+#define BUFFER_LENGTH (DUMP_OFFSET + MAX_DUMP_LENGTH + 1)
+#define NUM_OF_BUFFERS 2
+
+// Private types
+typedef struct
+{
+  volatile uint8_t busy; // Set while the frame is queued or being sent
+  uint8_t data[BUFFER_LENGTH];
+} CaptureBuffer;
+
+// Private global variables
+static CaptureBuffer buffers[NUM_OF_BUFFERS];
+static volatile uint8_t fullRequested = 0;
+static volatile uint32_t drops = 0;
+static uint16_t sequence = 0;
+
+// FUNCTION      : releaseBuffer
+// DESCRIPTION   :
+//    Called from the USART2 TX complete interrupt once a frame has been sent.
+// PARAMETERS    :
+//    const uint8_t* frame : The frame, the data of a capture buffer.
+// RETURNS       : None
+static void releaseBuffer(const uint8_t* frame)
+{
+  uint8_t i;
+
+  for (i = 0; i < NUM_OF_BUFFERS; i++)
+  {
+    if (frame == buffers[i].data)
+    {
+      buffers[i].busy = 0;
+    }
+  }
+}
+
+// FUNCTION      : getFreeBuffer
+// DESCRIPTION   : Finds a capture buffer which is not being sent.
+// PARAMETERS    : None
+// RETURNS       :
+//    CaptureBuffer* : The buffer, NULL when both are in use.
+static CaptureBuffer* getFreeBuffer(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < NUM_OF_BUFFERS; i++)
+  {
+    if (!buffers[i].busy)
+    {
+      return &buffers[i];
+    }
+  }
+
+  return NULL;
+}
+
+#endif
+
+// FUNCTION      : captureCir
+// DESCRIPTION   :
+//    Reads the CIR of the frame just received and queues it for USART2.
+//    Call right after dwt_readrxharvest() returned a good frame read with
+//    DWT_HARVEST_DIAG, before the receiver is enabled again. Does not wait
+//    for the previous dump to be sent.
+// PARAMETERS    :
+//    const dwt_config_t* config      : Configuration of the DW3000.
+//    const dwt_rxharvest_t* harvest  : Diagnostics of the frame.
+// RETURNS       : None
+void captureCir(const dwt_config_t* config, const dwt_rxharvest_t* harvest)
+{
+#if (CIR_CAPTURE_ENABLE == 1)
+  CaptureBuffer* buffer;
+  uint8_t* dump;
+  uint16_t firstSample;
+  uint16_t numOfSamples;
+  uint16_t dumpLength;
+  uint16_t frameLength;
+  uint8_t full;
+
+  // B1 has no interrupt enabled, but its EXTI line still latches a press
+  if (__HAL_GPIO_EXTI_GET_FLAG(B1_Pin))
+  {
+    __HAL_GPIO_EXTI_CLEAR_FLAG(B1_Pin);
+    fullRequested = 1;
+  }
+
+  if (!harvest->diagValid)
+  {
+    return;
+  }
+
+  buffer = getFreeBuffer();
+  if (buffer == NULL)
+  {
+    sequence++;
+    drops++;
+    return;
+  }
+
+  full = fullRequested;
+  if (full)
+  {
+    firstSample = 0;
+    numOfSamples = CIR_IPATOV_SAMPLES;
+  }
+  else
+  {
+    // Window around the integer part of the first path index
+    firstSample = harvest->ipatovFpIndex >> 6;
+    firstSample = (firstSample > CIR_WINDOW_LEAD) ? firstSample - CIR_WINDOW_LEAD : 0;
+    if (firstSample > CIR_IPATOV_SAMPLES - CIR_WINDOW_SAMPLES)
+    {
+      firstSample = CIR_IPATOV_SAMPLES - CIR_WINDOW_SAMPLES;
+    }
+    numOfSamples = CIR_WINDOW_SAMPLES;
+  }
+
+  // The first byte read from the accumulator is a dummy byte, it lands on the
+  // last header byte, which is written afterwards
+  dump = &buffer->data[DUMP_OFFSET];
+  dwt_readaccdata(&dump[HEADER_LENGTH - 1], numOfSamples * CIR_SAMPLE_BYTES + 1, firstSample);
+
+  dump[0] = CIR_FRAME_TYPE;
+  dump[1] = CIR_FORMAT_VERSION;
+  putLe16(&dump[2], sequence++);
+  putLe32(&dump[4], HAL_GetTick());
+  putLe16(&dump[8], firstSample);
+  putLe16(&dump[10], numOfSamples);
+  putLe16(&dump[12], harvest->ipatovFpIndex);
+  putLe16(&dump[14], harvest->ipatovAccumCount);
+  putLe32(&dump[16], harvest->ipatovPeak);
+  dump[20] = full ? CIR_FLAG_FULL : 0;
+  dump[21] = config->chan;
+  dump[22] = config->txPreambLength;
+  dump[23] = config->rxPAC;
+  dump[24] = config->rxCode;
+  dump[25] = config->sfdType;
+  dump[26] = config->dataRate;
+  dump[27] = 0;
+
+  dumpLength = HEADER_LENGTH + numOfSamples * CIR_SAMPLE_BYTES;
+  putLe16(&dump[dumpLength], computeTelemetryCrc(dump, dumpLength));
+  dumpLength += CRC_LENGTH;
+
+  buffer->data[0] = 0;
+  frameLength = 1 + encodeTelemetryCobs(&buffer->data[1], dump, dumpLength);
+  buffer->data[frameLength++] = 0;
+
+  buffer->busy = 1;
+  if (port_tx_block(buffer->data, frameLength, releaseBuffer) != HAL_OK)
+  {
+    buffer->busy = 0;
+    drops++;
+    return;
+  }
+
+  if (full)
+  {
+    fullRequested = 0;
+  }
+#else
+  (void)config;
+  (void)harvest;
+#endif
+}
+
+// FUNCTION      : requestFullCirCapture
+// DESCRIPTION   :
+//    Makes the next dump the full Ipatov CIR instead of a window. Can be
+//    called from interrupts.
+// PARAMETERS    : None
+// RETURNS       : None
+void requestFullCirCapture(void)
+{
+#if (CIR_CAPTURE_ENABLE == 1)
+  fullRequested = 1;
+#endif
+}
+
+// FUNCTION      : getCirCaptureDrops
+// DESCRIPTION   : Number of dumps dropped because the UART could not keep up.
+// PARAMETERS    : None
+// RETURNS       :
+//    uint32_t : Dropped dumps since reset.
+uint32_t getCirCaptureDrops(void)
+{
+#if (CIR_CAPTURE_ENABLE == 1)
+  return drops;
+#else
+  return 0;
+#endif
+}
@@ -24,6 +24,7 @@
 //
 
 //#define DWT_API_ERROR_CHECK  /* API checks config input parameters */
+#define DWT_SPI_HW_CRC       /* SPI CRC-8 on writes is generated by the host SPI peripheral, see writetospiwithhwcrc() */
 
 /* STS Minimum Threshold (STS_MNTH) needs to be adjusted with changing STS length.
 To adjust the STS_MNTH following formula can be used: STS_MNTH = SQRT(X/Y)*default_STS_MNTH
@@ -250,6 +251,8 @@ void dwt_xfer3000
         cnt = 2;
     }
 
+    DWT_SPI_TRACE_START();
+
     switch (mode)
     {
     case    DW3000_SPI_AND_OR_8:
@@ -257,26 +260,33 @@ void dwt_xfer3000
     case    DW3000_SPI_AND_OR_32:
     case    DW3000_SPI_WR_BIT:
     {
-        uint8_t crc8 = 0;
         if (pdw3000local->spicrc != DWT_SPI_CRC_MODE_NO)
         {
+#ifdef DWT_SPI_HW_CRC
+            // Write it to the SPI, the CRC byte is appended by the SPI peripheral
+            writetospiwithhwcrc(cnt, header, length, buffer);
+#else
+            uint8_t crc8;
             //generate 8 bit CRC
             crc8 = dwt_generatecrc8(header, cnt, 0);
             crc8 = dwt_generatecrc8(buffer, length, crc8);
 
             // Write it to the SPI
             writetospiwithcrc(cnt, header, length, buffer, crc8);
+#endif
         }
         else
         {
             // Write it to the SPI
             writetospi(cnt, header, length, buffer);
         }
+        DWT_SPI_TRACE_STOP(regFileID, indx, length, mode, cnt);
         break;
     }
     case DW3000_SPI_RD_BIT:
         {
             readfromspi(cnt, header, length, buffer);
+            DWT_SPI_TRACE_STOP(regFileID, indx, length, mode, cnt);
 
             //check that the SPI read has correct CRC-8 byte
             //also don't do for SPICRC_CFG_ID register itself to prevent infinite recursion
@@ -2273,6 +2283,108 @@ void dwt_readdiagnostics(dwt_rxdiag_t *diagnostics)
     }
 }
 
+/*! ------------------------------------------------------------------------------------------------------------------
+ * @brief this function reads SYS_STATUS, SYS_STATUS_HI and RX_FINFO in one SPI burst, see dwt_readrxharvest()
+ *
+ * input parameters
+ * @param harvest - harvest structure pointer, status, statusHi and frameLength are filled in
+ *
+ * output parameters
+ *
+ * returns the low 32 bits of SYS_STATUS
+ */
+uint32_t dwt_readrxharveststatus(dwt_rxharvest_t *harvest)
+{
+    uint8_t temp[RX_FINFO_ID + 4 - SYS_STATUS_ID];     // 0x44 to 0x4F
+
+    dwt_readfromdevice(SYS_STATUS_ID, 0, sizeof(temp), temp);
+
+    harvest->status = (uint32_t)temp[3] << 24 | (uint32_t)temp[2] << 16 | (uint32_t)temp[1] << 8 | temp[0];
+    harvest->statusHi = (uint32_t)temp[SYS_STATUS_HI_ID - SYS_STATUS_ID + 3] << 24 | (uint32_t)temp[SYS_STATUS_HI_ID - SYS_STATUS_ID + 2] << 16
+        | (uint32_t)temp[SYS_STATUS_HI_ID - SYS_STATUS_ID + 1] << 8 | temp[SYS_STATUS_HI_ID - SYS_STATUS_ID];
+    harvest->frameLength = ((uint16_t)temp[RX_FINFO_ID - SYS_STATUS_ID + 1] << 8 | temp[RX_FINFO_ID - SYS_STATUS_ID]) & RX_FINFO_RXFLEN_BIT_MASK;
+
+    return harvest->status;
+}
+
+/*! ------------------------------------------------------------------------------------------------------------------
+ * @brief this function gathers the timestamps, payload, clock offset and (optionally) first path diagnostics of a
+ *        received frame in the minimum number of SPI bursts and clears the consumed events, see deca_device_api.h
+ *
+ *        SPI transactions per good frame: timestamps (21 bytes), payload, CIA_DIAG_0 (2 bytes, or 60 bytes up to
+ *        IP_DIAG_12 with DWT_HARVEST_DIAG) and the status clear; 4 in total after dwt_readrxharveststatus().
+ *
+ * input parameters
+ * @param harvest   - harvest structure pointer, filled in by dwt_readrxharveststatus()
+ * @param payload   - buffer for the frame payload
+ * @param maxLength - size of the payload buffer
+ * @param flags     - 0 or DWT_HARVEST_DIAG
+ *
+ * output parameters
+ *
+ * returns DWT_SUCCESS when a good frame was read, DWT_ERROR otherwise
+ */
+int dwt_readrxharvest(dwt_rxharvest_t *harvest, uint8_t *payload, uint16_t maxLength, uint8_t flags)
+{
+    uint8_t  temp[IP_DIAG_12_ID + 4 - CIA_DIAG_0_ID];    // 0xC0020 to 0xC005B, also holds the timestamps
+    uint16_t regval;
+    int      i;
+    int      retval = DWT_ERROR;
+
+    harvest->diagValid = 0;
+
+    if ((harvest->status & SYS_STATUS_RXFCG_BIT_MASK) && (pdw3000local->dblbuffon == DBL_BUFF_OFF)
+        && (harvest->frameLength <= maxLength))
+    {
+        // RX_TIME_0 (0x64) to TX_TIME_HI (0x78) in one burst: both 40-bit timestamps
+        dwt_readfromdevice(RX_TIME_0_ID, 0, TX_TIME_LO_ID + TX_TIME_TX_STAMP_LEN - RX_TIME_0_ID, temp);
+        for (i = 0; i < RX_TIME_RX_STAMP_LEN; i++)
+        {
+            harvest->rxStamp[i] = temp[i];
+            harvest->txStamp[i] = temp[TX_TIME_LO_ID - RX_TIME_0_ID + i];
+        }
+
+        if (harvest->frameLength > 0)
+        {
+            dwt_readfromdevice(RX_BUFFER_0_ID, 0, harvest->frameLength, payload);
+        }
+
+        if (flags & DWT_HARVEST_DIAG)
+        {
+            dwt_readfromdevice(CIA_DIAG_0_ID, 0, IP_DIAG_12_ID + 4 - CIA_DIAG_0_ID, temp);
+
+            harvest->ipatovPeak = ((uint32_t)temp[IP_DIAG_0_ID - CIA_DIAG_0_ID + 3] << 24 | (uint32_t)temp[IP_DIAG_0_ID - CIA_DIAG_0_ID + 2] << 16
+                | (uint32_t)temp[IP_DIAG_0_ID - CIA_DIAG_0_ID + 1] << 8 | (uint32_t)temp[IP_DIAG_0_ID - CIA_DIAG_0_ID]) & 0x7FFFFFFF;  // index [30:21] and amplitude [20:0] of peak sample in Ipatov sequence CIR
+            harvest->ipatovPower = ((uint32_t)temp[IP_DIAG_1_ID - CIA_DIAG_0_ID + 3] << 24 | (uint32_t)temp[IP_DIAG_1_ID - CIA_DIAG_0_ID + 2] << 16
+                | (uint32_t)temp[IP_DIAG_1_ID - CIA_DIAG_0_ID + 1] << 8 | (uint32_t)temp[IP_DIAG_1_ID - CIA_DIAG_0_ID]) & 0x1FFFF;     // channel area [16:0] for the Ipatov sequence
+            harvest->ipatovFpIndex = (uint16_t)temp[IP_DIAG_8_ID - CIA_DIAG_0_ID + 1] << 8 | temp[IP_DIAG_8_ID - CIA_DIAG_0_ID];       // First path index [15:0] for Ipatov sequence
+            harvest->ipatovAccumCount = ((uint16_t)temp[IP_DIAG_12_ID - CIA_DIAG_0_ID + 1] << 8 | temp[IP_DIAG_12_ID - CIA_DIAG_0_ID]) & 0xFFF; // Number accumulated symbols [11:0]
+            harvest->diagValid = 1;
+        }
+        else
+        {
+            dwt_readfromdevice(CIA_DIAG_0_ID, 0, 2, temp);
+        }
+
+        regval = ((uint16_t)temp[1] << 8 | temp[0]) & CIA_DIAG_0_COE_PPM_BIT_MASK;
+        if (regval & B11_SIGN_EXTEND_TEST)
+        {
+            regval |= B11_SIGN_EXTEND_MASK;             // sign extend bit #12 to the whole short
+        }
+        harvest->clockOffset = (int16_t)regval;
+
+        retval = DWT_SUCCESS;
+    }
+
+    // Clear only the RX events that were seen in the status read
+    if (harvest->status & (SYS_STATUS_ALL_RX_GOOD | SYS_STATUS_ALL_RX_TO | SYS_STATUS_ALL_RX_ERR))
+    {
+        dwt_write32bitreg(SYS_STATUS_ID, harvest->status & (SYS_STATUS_ALL_RX_GOOD | SYS_STATUS_ALL_RX_TO | SYS_STATUS_ALL_RX_ERR));
+    }
+
+    return retval;
+}
+
 /*! ------------------------------------------------------------------------------------------------------------------
  * @brief This is used to read the TX timestamp (adjusted with the programmed antenna delay)
  *
@@ -23,6 +23,20 @@ extern "C" {
 #define DWT_NUM_DW_DEV (1)
 #endif
 
+//#define DWT_SPI_TRACE     /* record every SPI transaction made by the driver, see spitrace_begin()/spitrace_end() */
+
+/* SPI transaction trace hooks. The platform provides spitrace_begin() and spitrace_end() (deca_spi_trace.c).
+ * When DWT_SPI_TRACE is not defined the hooks expand to nothing and no trace code or data is linked in. */
+#ifdef DWT_SPI_TRACE
+extern uint32_t spitrace_begin(void);
+extern void spitrace_end(uint32_t start, uint32_t regFileID, uint16_t indx, uint16_t length, uint16_t mode, uint16_t headerLength);
+#define DWT_SPI_TRACE_START()                                   uint32_t spitrace_t0 = spitrace_begin()
+#define DWT_SPI_TRACE_STOP(regFileID, indx, length, mode, hdr)  spitrace_end(spitrace_t0, (regFileID), (indx), (length), (mode), (hdr))
+#else
+#define DWT_SPI_TRACE_START()
+#define DWT_SPI_TRACE_STOP(regFileID, indx, length, mode, hdr)
+#endif
+
 
 #define DWT_BIT_MASK(bit_num)   (((uint32_t)1)<<(bit_num))
 
@@ -485,6 +499,24 @@ typedef struct
 
 } dwt_rxdiag_t ;
 
+// Everything a ranging exchange needs from a received frame, gathered by dwt_readrxharveststatus()/dwt_readrxharvest()
+typedef struct
+{
+    uint32_t      status ;            // SYS_STATUS (low 32 bits)
+    uint32_t      statusHi ;          // SYS_STATUS_HI
+    uint32_t      ipatovPeak ;        // index and amplitude of peak sample in Ipatov sequence CIR (DWT_HARVEST_DIAG only)
+    uint32_t      ipatovPower ;       // channel area for the Ipatov sequence (DWT_HARVEST_DIAG only)
+    uint16_t      frameLength ;       // RX_FINFO RXFLEN, including the 2 byte FCS
+    int16_t       clockOffset ;       // as returned by dwt_readclockoffset()
+    uint16_t      ipatovFpIndex ;     // first path index for Ipatov sequence (DWT_HARVEST_DIAG only)
+    uint16_t      ipatovAccumCount ;  // number accumulated symbols for Ipatov sequence (DWT_HARVEST_DIAG only)
+    uint8_t       rxStamp[5] ;        // adjusted RX timestamp (RX_TIME_0)
+    uint8_t       txStamp[5] ;        // TX timestamp of the last frame sent (TX_TIME_LO/HI)
+    uint8_t       diagValid ;         // non-zero when the DWT_HARVEST_DIAG fields were read
+} dwt_rxharvest_t ;
+
+#define DWT_HARVEST_DIAG        0x1     // dwt_readrxharvest() also reads the Ipatov first path diagnostics
+
 
 typedef struct
 {
@@ -1831,6 +1863,42 @@ int dwt_readstsstatus(uint16_t* stsStatus, int sts_num);
  */
 void dwt_readdiagnostics(dwt_rxdiag_t * diagnostics);
 
+/*! ------------------------------------------------------------------------------------------------------------------
+ * @brief this function reads SYS_STATUS, SYS_STATUS_HI and RX_FINFO in one SPI burst. It is meant to be used as the
+ *        status poll (or the first read in the interrupt handler) ahead of dwt_readrxharvest(), so that the frame
+ *        length is already known when a frame arrives.
+ *
+ * input parameters
+ * @param harvest - harvest structure pointer, status, statusHi and frameLength are filled in
+ *
+ * output parameters
+ *
+ * returns the low 32 bits of SYS_STATUS
+ */
+uint32_t dwt_readrxharveststatus(dwt_rxharvest_t *harvest);
+
+/*! ------------------------------------------------------------------------------------------------------------------
+ * @brief this function gathers the rest of a received frame after dwt_readrxharveststatus() in the minimum number of
+ *        SPI bursts: both 40-bit timestamps (RX_TIME_0 to TX_TIME_HI, one burst), the payload, and the clock offset
+ *        (CIA_DIAG_0) or, with DWT_HARVEST_DIAG, CIA_DIAG_0 to IP_DIAG_12 in one burst. It then clears the RX good,
+ *        timeout and error events that were set in harvest->status with a single write, so events raised after the
+ *        status read are not lost.
+ *        When the status does not show a good frame (RXFCG), only the events are cleared.
+ *
+ * NOTE: Double buffer mode is not supported, use dwt_readrxdata()/dwt_readdiagnostics() there.
+ *
+ * input parameters
+ * @param harvest   - harvest structure pointer, filled in by dwt_readrxharveststatus()
+ * @param payload   - buffer for the frame payload, may be NULL if maxLength is 0
+ * @param maxLength - size of the payload buffer, frames longer than this are not read
+ * @param flags     - 0 or DWT_HARVEST_DIAG
+ *
+ * output parameters
+ *
+ * returns DWT_SUCCESS when a good frame was read, DWT_ERROR otherwise
+ */
+int dwt_readrxharvest(dwt_rxharvest_t *harvest, uint8_t *payload, uint16_t maxLength, uint8_t flags);
+
 /*! ------------------------------------------------------------------------------------------------------------------
  * @brief This is used to enable/disable the event counter in the IC
  *
@@ -2350,6 +2418,27 @@ void dwt_wakeup_ic(void);
  */
 extern int writetospiwithcrc(uint16_t headerLength, const uint8_t *headerBuffer, uint16_t bodylength, const uint8_t *bodyBuffer, uint8_t crc8);
 
+/*! ------------------------------------------------------------------------------------------------------------------
+ * @brief
+ * Low level abstract function to write to the SPI when DW3000 SPI CRC mode is used and the host SPI peripheral
+ * can generate the CRC-8 (polynomial 0x07, zero seed) in hardware. The CRC byte is calculated on the header and
+ * data bytes as they are shifted out and appended to the transfer, so no software CRC is needed.
+ * Only used when DWT_SPI_HW_CRC is defined in deca_device.c
+ *
+ * Note: The body of this function is defined in deca_spi.c and is platform specific
+ *
+ * input parameters:
+ * @param headerLength  - number of bytes header being written
+ * @param headerBuffer  - pointer to buffer containing the 'headerLength' bytes of header to be written
+ * @param bodylength    - number of bytes data being written
+ * @param bodyBuffer    - pointer to buffer containing the 'bodylength' bytes od data to be written
+ *
+ * output parameters
+ *
+ * returns DWT_SUCCESS for success, or DWT_ERROR for error
+ */
+extern int writetospiwithhwcrc(uint16_t headerLength, const uint8_t *headerBuffer, uint16_t bodylength, const uint8_t *bodyBuffer);
+
 /*! ------------------------------------------------------------------------------------------------------------------
  * @brief
  * NB: In porting this to a particular microprocessor, the implementer needs to define the two low
@@ -0,0 +1,137 @@
+/*! ----------------------------------------------------------------------------
+ * @file    deca_fastreg.h
+ * @brief   Compile-time specialised DW3000 register access
+ *
+ *          dwt_xfer3000() works out the register file, offset, access mode (FAC/FARW/EAMRW) and SPI header at
+ *          run time for every access. Nearly all call sites pass constant addresses from deca_regs.h, so the
+ *          macros below compute the header bytes and header length in the preprocessor/compiler instead, and the
+ *          always-inline accessors reduce to filling a 1-2 byte header with immediates and one call to
+ *          writetospi()/readfromspi().
+ *
+ *          Field access uses the deca_regs.h naming (<REG>_ID, <REG>_<FIELD>_BIT_MASK, <REG>_<FIELD>_BIT_OFFSET):
+ *
+ *              len = DWT_FAST_FIELD_READ32(RX_FINFO, RXFLEN);
+ *
+ * NOTE:    These accessors bypass the driver's SPI CRC mode (dwt_enablespicrccheck()): no CRC byte is appended to
+ *          writes and reads are not verified. Only use them when SPI CRC mode is off, which is the default.
+ *          The address must be a register file ID plus an offset of at most 0x7F, as for dwt_xfer3000().
+ *          They are traced like any other transaction when DWT_SPI_TRACE is defined.
+ */
+
+#ifndef _DECA_FASTREG_H_
+#define _DECA_FASTREG_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "deca_types.h"
+#include "deca_regs.h"
+#include "deca_device_api.h"
+
+#define DWT_FAST_INLINE     static inline __attribute__((always_inline))
+
+/* Register file and offset of a full address (regFileID + index) */
+#define DWT_FAST_FILE(addr)             (0x1FU & ((uint32_t)(addr) >> 16))
+#define DWT_FAST_OFFSET(addr)           (0x7FU & (uint32_t)(addr))
+
+/* Header length: short (FARW) addressing when the offset is 0, full (EAMRW) addressing otherwise */
+#define DWT_FAST_HDR_LEN(addr)          (DWT_FAST_OFFSET(addr) ? 2U : 1U)
+
+/* Header bytes for a read (DW3000_SPI_RD_BIT) or write (DW3000_SPI_WR_BIT) of 'addr', as built by dwt_xfer3000() */
+#define DWT_FAST_HDR0(addr, rw)         ((uint8_t)(((uint16_t)(rw) >> 8) | (DWT_FAST_FILE(addr) << 1) | \
+                                                   (DWT_FAST_OFFSET(addr) ? (0x40U | (DWT_FAST_OFFSET(addr) >> 6)) : 0U)))
+#define DWT_FAST_HDR1(addr, rw)         ((uint8_t)(DWT_FAST_OFFSET(addr) << 2))
+
+/* Fast access command header byte (no data) */
+#define DWT_FAST_CMD_HDR(cmd)           ((uint8_t)(0x80U | ((cmd) << 1) | 0x01U))
+
+/* Field extraction/insertion using the deca_regs.h names */
+#define DWT_FAST_FIELD_GET(reg, field, val)     (((val) & reg##_##field##_BIT_MASK) >> reg##_##field##_BIT_OFFSET)
+#define DWT_FAST_FIELD_SET(reg, field, val)     (((uint32_t)(val) << reg##_##field##_BIT_OFFSET) & reg##_##field##_BIT_MASK)
+#define DWT_FAST_FIELD_READ32(reg, field)       DWT_FAST_FIELD_GET(reg, field, dwt_fast_read32(reg##_ID))
+
+/*! ------------------------------------------------------------------------------------------------------------------
+ * @brief Reads 'length' bytes starting at the constant address 'addr' in one SPI burst.
+ */
+DWT_FAST_INLINE void dwt_fast_readbytes(const uint32_t addr, uint16_t length, uint8_t *buffer)
+{
+    uint8_t header[2] = { DWT_FAST_HDR0(addr, DW3000_SPI_RD_BIT), DWT_FAST_HDR1(addr, DW3000_SPI_RD_BIT) };
+    DWT_SPI_TRACE_START();
+
+    readfromspi(DWT_FAST_HDR_LEN(addr), header, length, buffer);
+    DWT_SPI_TRACE_STOP(addr, 0, length, DW3000_SPI_RD_BIT, DWT_FAST_HDR_LEN(addr));
+}
+
+/*! ------------------------------------------------------------------------------------------------------------------
+ * @brief Writes 'length' bytes starting at the constant address 'addr' in one SPI burst.
+ */
+DWT_FAST_INLINE void dwt_fast_writebytes(const uint32_t addr, uint16_t length, const uint8_t *buffer)
+{
+    uint8_t header[2] = { DWT_FAST_HDR0(addr, DW3000_SPI_WR_BIT), DWT_FAST_HDR1(addr, DW3000_SPI_WR_BIT) };
+    DWT_SPI_TRACE_START();
+
+    writetospi(DWT_FAST_HDR_LEN(addr), header, length, buffer);
+    DWT_SPI_TRACE_STOP(addr, 0, length, DW3000_SPI_WR_BIT, DWT_FAST_HDR_LEN(addr));
+}
+
+/*! ------------------------------------------------------------------------------------------------------------------
+ * @brief Issues the fast command 'cmd' (CMD_TX, CMD_TX_W4R, CMD_TXRXOFF, ...), one header byte and no data.
+ */
+DWT_FAST_INLINE void dwt_fast_cmd(const uint8_t cmd)
+{
+    uint8_t header = DWT_FAST_CMD_HDR(cmd);
+    DWT_SPI_TRACE_START();
+
+    writetospi(1, &header, 0, NULL);
+    DWT_SPI_TRACE_STOP(cmd, 0, 0, DW3000_SPI_WR_BIT, 1);
+}
+
+DWT_FAST_INLINE uint32_t dwt_fast_read32(const uint32_t addr)
+{
+    uint8_t buffer[4];
+
+    dwt_fast_readbytes(addr, 4, buffer);
+    return ((uint32_t)buffer[3] << 24) | ((uint32_t)buffer[2] << 16) | ((uint32_t)buffer[1] << 8) | buffer[0];
+}
+
+DWT_FAST_INLINE uint16_t dwt_fast_read16(const uint32_t addr)
+{
+    uint8_t buffer[2];
+
+    dwt_fast_readbytes(addr, 2, buffer);
+    return (uint16_t)(((uint16_t)buffer[1] << 8) | buffer[0]);
+}
+
+DWT_FAST_INLINE uint8_t dwt_fast_read8(const uint32_t addr)
+{
+    uint8_t buffer;
+
+    dwt_fast_readbytes(addr, 1, &buffer);
+    return buffer;
+}
+
+DWT_FAST_INLINE void dwt_fast_write32(const uint32_t addr, uint32_t value)
+{
+    uint8_t buffer[4] = { (uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24) };
+
+    dwt_fast_writebytes(addr, 4, buffer);
+}
+
+DWT_FAST_INLINE void dwt_fast_write16(const uint32_t addr, uint16_t value)
+{
+    uint8_t buffer[2] = { (uint8_t)value, (uint8_t)(value >> 8) };
+
+    dwt_fast_writebytes(addr, 2, buffer);
+}
+
+DWT_FAST_INLINE void dwt_fast_write8(const uint32_t addr, uint8_t value)
+{
+    dwt_fast_writebytes(addr, 1, &value);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DECA_FASTREG_H_ */
@@ -8,6 +8,6 @@
 #ifndef INC_SS_TWR_RESPONDER_H_
 #define INC_SS_TWR_RESPONDER_H_
 
-int ss_twr_responder(void);
+void ss_twr_responder(void);
 
 #endif /* INC_SS_TWR_RESPONDER_H_ */
@@ -0,0 +1,224 @@
+/*******************************************************************************
+  * File Name          : display_task.c
+  * Description        :
+  *    Renders the latest ranging result on the OLED display at a fixed frame
+  *    rate, decoupled from the ranging task by a single-slot mailbox.
+  *
+  *    The ranging side only stores its result with publishRange() or
+  *    publishNoRange(), which never block. pollDisplayTask() renders the newest
+  *    result once per frame period; results published in between are dropped.
+  *    The mailbox is a seqlock, so it can also be written from an interrupt
+  *    while the display side reads it.
+  ******************************************************************************
+  */
+#include "display_task.h"
+#include "text_field.h"
+#include "range_graph.h"
+#include "ssd1331_band.h"
+#include "config_options.h"
+#include "main.h"
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+
+// Private defines
+#define FRAME_PERIOD_MS  (1000 / DISPLAY_FRAME_RATE_HZ)
+#define DIST_FIELD_CHARS 8 // "xxx.xx m"
+
+// Private data types
+typedef struct
+{
+  double distance;
+  uint8_t isValid; // 0 when no response was received
+} RangeResult;
+
+// Mailbox holding the latest result. The sequence number is odd while the
+// writer is updating the result; it also tells the reader if there is anything new.
+typedef struct
+{
+  volatile uint32_t sequence;
+  RangeResult result;
+} RangeMailbox;
+
+// Private global variables
+static RangeMailbox mailbox = { 0 };
+static uint32_t renderedSequence = 0;
+static uint32_t lastFrameTick = 0;
+
+// Distance readout in the top right corner
+static TextField distanceField;
+
+// FUNCTION      : writeMailbox
+// DESCRIPTION   :
+//    Stores a result in the mailbox, replacing the previous one.
+// PARAMETERS    :
+//    const RangeResult* result : Result to be stored.
+// RETURNS       : None
+static void writeMailbox(const RangeResult* result)
+{
+  mailbox.sequence++;
+  __DMB();
+  mailbox.result = *result;
+  __DMB();
+  mailbox.sequence++;
+}
+
+// FUNCTION      : readMailbox
+// DESCRIPTION   :
+//    Takes a consistent copy of the latest result, retrying if a write
+//    happened during the copy.
+// PARAMETERS    :
+//    RangeResult* result : Copy of the result.
+// RETURNS       :
+//    uint32_t : Sequence number of the copied result.
+static uint32_t readMailbox(RangeResult* result)
+{
+  uint32_t sequence;
+
+  do
+  {
+    sequence = mailbox.sequence;
+    __DMB();
+    *result = mailbox.result;
+    __DMB();
+  } while ((sequence & 1) || sequence != mailbox.sequence);
+
+  return sequence;
+}
+
+// FUNCTION      : selectColour
+// DESCRIPTION   :
+//    Chooses the readout colour from the distance.
+// PARAMETERS    :
+//    double distance : Distance in metres.
+// RETURNS       :
+//    enum Color : Font colour.
+static enum Color selectColour(double distance)
+{
+  if (distance > 4.5)
+  {
+    return RED;
+  }
+  if (distance > 2.0)
+  {
+    return ORANGE;  // I had to add orange into ssd1331.h
+  }
+  if (distance > 0.5)
+  {
+    return YELLOW;
+  }
+  return GREEN;
+}
+
+#if (SSD1331_BAND_RENDERER == 1)
+// FUNCTION      : renderBands
+// DESCRIPTION   :
+//    Describes the whole screen to the band renderer and renders it: the
+//    readout right aligned in the top right corner and the range history chart.
+//    Only the bands that changed are sent.
+// PARAMETERS    :
+//    const char* text     : Distance readout, "" for none.
+//    enum Color txtColour : Font colour.
+// RETURNS       : None
+static void renderBands(const char* text, enum Color txtColour)
+{
+  const uint8_t txtWidth = strlen(text) * (FONT_LARGE / 2);
+
+  ssd1331_band_clear(BLACK);
+  if (txtWidth > 0 && txtWidth <= OLED_WIDTH)
+  {
+    ssd1331_band_text(OLED_WIDTH - txtWidth, 0, text, FONT_LARGE, txtColour);
+  }
+  addRangeGraphToBands();
+  ssd1331_band_render();
+}
+#endif
+
+// FUNCTION      : initDisplayTask
+// DESCRIPTION   :
+//    Places the distance readout and the range history chart on the display.
+//    Call once after ssd1331_init().
+// PARAMETERS    : None
+// RETURNS       : None
+void initDisplayTask(void)
+{
+  initTextField(&distanceField, DIST_FIELD_CHARS, FONT_LARGE, ALIGN_RIGHT, TOP_RIGHT);
+  initRangeGraph();
+  lastFrameTick = HAL_GetTick();
+}
+
+// FUNCTION      : publishRange
+// DESCRIPTION   :
+//    Publishes a new distance to be shown on the next frame. Does not block.
+// PARAMETERS    :
+//    double distance : Distance in metres.
+// RETURNS       : None
+void publishRange(double distance)
+{
+  const RangeResult result = { distance, 1 };
+
+  writeMailbox(&result);
+}
+
+// FUNCTION      : publishNoRange
+// DESCRIPTION   :
+//    Publishes that no response was received, which clears the readout on the
+//    next frame. Does not block.
+// PARAMETERS    : None
+// RETURNS       : None
+void publishNoRange(void)
+{
+  const RangeResult result = { 0.0, 0 };
+
+  writeMailbox(&result);
+}
+
+// FUNCTION      : pollDisplayTask
+// DESCRIPTION   :
+//    Renders the newest published result if a frame period has passed since the
+//    last frame and something new was published: the distance readout, one new
+//    column of the range history chart. Call after publishing, when a display
+//    flush completes and once per frame period; it returns at once otherwise.
+// PARAMETERS    : None
+// RETURNS       : None
+void pollDisplayTask(void)
+{
+  RangeResult result;
+  uint32_t sequence;
+  enum Color colour;
+  unsigned long distanceCm;
+
+  // Push out anything drawn while the previous display flush was still on the bus
+  ssd1331_flush();
+
+  if ((HAL_GetTick() - lastFrameTick) < FRAME_PERIOD_MS || mailbox.sequence == renderedSequence)
+  {
+    return;
+  }
+
+  sequence = readMailbox(&result);
+  lastFrameTick = HAL_GetTick();
+  renderedSequence = sequence;
+
+  if (!result.isValid)
+  {
+    addRangeGraphGap();
+#if (SSD1331_BAND_RENDERER == 1)
+    renderBands("", BLACK);
+#else
+    clearTextField(&distanceField);
+#endif
+    return;
+  }
+
+  colour = selectColour(result.distance);
+  // Integer formatting, so newlib's float printf support is not linked in
+  distanceCm = (unsigned long)lround(fabs(result.distance) * 100.0);
+  snprintf(dist_str, sizeof(dist_str), "%lu.%02lu m", distanceCm / 100, distanceCm % 100);
+  addRangeGraphSample(result.distance, colour);
+#if (SSD1331_BAND_RENDERER == 1)
+  renderBands(dist_str, colour);
+#else
+  updateTextField(&distanceField, dist_str, colour);
+#endif
+}
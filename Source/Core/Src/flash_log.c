@@ -0,0 +1,646 @@
+/*******************************************************************************
+  * File Name          : flash_log.c
+  * Description        :
+  *    Ring log of the ranging exchanges in flash, see flash_log.h.
+  *
+  *    The STM32F411 has a single flash bank: the CPU stalls on any fetch
+  *    from flash while a word is programmed (16 us) or a sector is erased
+  *    (1 to 2 s for 128 kB). Programming is therefore spread over the idle
+  *    time, 8 words per pollFlashLog(), and the erase, once per sector, is
+  *    done when the record that does not fit any more is appended.
+  ******************************************************************************
+  */
+#include "flash_log.h"
+#include "main.h"
+#include "usart.h"
+#include "tlog.h"
+#include <port.h>
+#include <string.h>
+
+#if (FLASH_LOG_ENABLE == 1)
+
+// Private defines
+#define NUM_OF_SECTORS    2
+#define SECTOR_SIZE       0x20000
+#define HEADER_LENGTH     16
+#define CRC_LENGTH        2
+#define RECORD_OVERHEAD   (1 + CRC_LENGTH) // Length and CRC
+#define MAX_PAYLOAD       16
+#define MAX_RECORD_LENGTH (RECORD_OVERHEAD + MAX_PAYLOAD)
+#define ERASED            0xFF
+#define PADDING           0x00
+#define STAGING_SIZE      512 // Power of 2
+#define WORDS_PER_POLL    8
+#define DUMP_HEADER_LENGTH 9
+#define DUMP_CHUNK        192
+#define END_LENGTH        8
+
+// Private types
+typedef struct
+{
+  uint32_t address;
+  uint32_t sector;
+} LogSector;
+
+// Private global variables
+static const LogSector logSectors[NUM_OF_SECTORS] =
+{
+  { 0x08040000, FLASH_SECTOR_6 },
+  { 0x08060000, FLASH_SECTOR_7 }
+};
+
+static uint8_t failed = 0;
+static uint8_t active = 0;          // Sector being written
+static uint32_t activeSequence = 0;
+static uint32_t appendOffset = 0;   // End of the records in the active sector, staged ones included
+static uint32_t programOffset = 0;  // End of the programmed records
+static uint32_t lastTimestampMs = 0;
+static int32_t lastRangeMm = 0;
+static uint32_t drops = 0;
+
+// Staged bytes, programmed to programOffset onwards
+static uint8_t staging[STAGING_SIZE];
+static uint32_t stagingHead = 0;
+static uint32_t stagingTail = 0;
+
+static uint8_t commandByte;
+static volatile uint8_t listenAgain = 0; // Arming the reception failed in an interrupt
+static volatile uint8_t dumpRequested = 0;
+static uint8_t dumpRunning = 0;
+static uint8_t dumpFlags = 0;
+static uint8_t dumpSector = 0;
+static uint8_t dumpSectorsLeft = 0;
+static uint32_t dumpSequence = 0;
+static uint32_t dumpOffset = 0;
+static uint32_t dumpEnd = 0;
+static uint16_t dumpFrames = 0;
+static volatile uint8_t dumpFrameBusy = 0;
+static uint8_t dumpPayload[DUMP_HEADER_LENGTH + DUMP_CHUNK + CRC_LENGTH];
+static uint8_t dumpFrame[DUMP_HEADER_LENGTH + DUMP_CHUNK + TELEMETRY_FRAME_OVERHEAD];
+
+// FUNCTION      : putVarint
+// DESCRIPTION   : Stores a value 7 bits a byte, low bits first.
+// PARAMETERS    :
+//    uint8_t* dst   : Destination, 5 bytes at most are written.
+//    uint32_t value : Value.
+// RETURNS       :
+//    uint8_t : Number of bytes written.
+static uint8_t putVarint(uint8_t* dst, uint32_t value)
+{
+  uint8_t length = 0;
+
+  while (value >= 0x80)
+  {
+    dst[length++] = value | 0x80;
+    value >>= 7;
+  }
+  dst[length++] = value;
+
+  return length;
+}
+
+// FUNCTION      : readSectorHeader
+// DESCRIPTION   : Checks the header of a log sector.
+// PARAMETERS    :
+//    uint8_t index      : Log sector.
+//    uint32_t* sequence : Sequence of the sector, when the header is valid.
+// RETURNS       :
+//    uint8_t : 1 when the header is valid, 0 otherwise.
+static uint8_t readSectorHeader(uint8_t index, uint32_t* sequence)
+{
+  const uint8_t* header = (const uint8_t*)logSectors[index].address;
+
+  if (getLe32(header) != FLASH_LOG_MAGIC || header[8] != FLASH_LOG_VERSION ||
+      getLe16(&header[14]) != computeTelemetryCrc(header, 14))
+  {
+    return 0;
+  }
+
+  *sequence = getLe32(&header[4]);
+  return 1;
+}
+
+// FUNCTION      : findLogEnd
+// DESCRIPTION   :
+//    Walks the records of a log sector up to the first erased byte where a
+//    record would start. After a record cut by a power loss, that is where
+//    the cut record would have ended, which may be inside a word.
+// PARAMETERS    :
+//    uint8_t index : Log sector.
+// RETURNS       :
+//    uint32_t : Offset of that byte, SECTOR_SIZE when the sector is full or
+//               the rest of its word is not erased.
+static uint32_t findLogEnd(uint8_t index)
+{
+  const uint8_t* sector = (const uint8_t*)logSectors[index].address;
+  uint32_t offset = HEADER_LENGTH;
+
+  while (offset < SECTOR_SIZE && sector[offset] != ERASED)
+  {
+    offset += (sector[offset] == PADDING) ? 1 : sector[offset] + RECORD_OVERHEAD;
+  }
+
+  if (offset >= SECTOR_SIZE || *(const uint32_t*)&sector[offset & ~3UL] != 0xFFFFFFFF)
+  {
+    return SECTOR_SIZE;
+  }
+
+  return offset;
+}
+
+// FUNCTION      : stageBytes
+// DESCRIPTION   : Queues bytes to be programmed at appendOffset.
+// PARAMETERS    :
+//    const uint8_t* data : Data.
+//    uint8_t length      : Length of the data, the caller checks the space.
+// RETURNS       : None
+static void stageBytes(const uint8_t* data, uint8_t length)
+{
+  while (length--)
+  {
+    staging[stagingHead++ & (STAGING_SIZE - 1)] = *data++;
+    appendOffset++;
+  }
+}
+
+// FUNCTION      : padToWord
+// DESCRIPTION   : Stages padding up to the next word, so all staged bytes can be programmed.
+// PARAMETERS    : None
+// RETURNS       : None
+static void padToWord(void)
+{
+  const uint8_t padding = PADDING;
+
+  while (appendOffset & 3)
+  {
+    stageBytes(&padding, 1);
+  }
+}
+
+// FUNCTION      : programStaged
+// DESCRIPTION   :
+//    Programs whole words of staged bytes. The CPU stalls for about 16 us
+//    per word.
+// PARAMETERS    :
+//    uint32_t maxWords : Most words to program.
+// RETURNS       : None
+static void programStaged(uint32_t maxWords)
+{
+  uint32_t word;
+  uint8_t i;
+
+  if (failed || (stagingHead - stagingTail) < 4)
+  {
+    return;
+  }
+
+  HAL_FLASH_Unlock();
+  while ((stagingHead - stagingTail) >= 4 && maxWords--)
+  {
+    word = 0;
+    for (i = 0; i < 4; i++)
+    {
+      word |= (uint32_t)staging[(stagingTail + i) & (STAGING_SIZE - 1)] << (8 * i);
+    }
+
+    if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, logSectors[active].address + programOffset, word) != HAL_OK)
+    {
+      TLOG("[flash_log::programStaged] Error! Programming failed at 0x%08lX",
+           logSectors[active].address + programOffset);
+      failed = 1;
+      break;
+    }
+
+    stagingTail += 4;
+    programOffset += 4;
+  }
+  HAL_FLASH_Lock();
+}
+
+// FUNCTION      : formatSector
+// DESCRIPTION   :
+//    Erases a log sector, writes its header and makes it the active sector.
+//    Blocks for the erase, 1 to 2 s.
+// PARAMETERS    :
+//    uint8_t index     : Log sector.
+//    uint32_t sequence : Sequence of the sector.
+// RETURNS       : None
+static void formatSector(uint8_t index, uint32_t sequence)
+{
+  FLASH_EraseInitTypeDef erase = { 0 };
+  uint32_t sectorError;
+  uint8_t header[HEADER_LENGTH] = { 0 };
+  uint8_t i;
+
+  erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+  erase.Sector = logSectors[index].sector;
+  erase.NbSectors = 1;
+  erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+
+  putLe32(&header[0], FLASH_LOG_MAGIC);
+  putLe32(&header[4], sequence);
+  header[8] = FLASH_LOG_VERSION;
+  putLe16(&header[14], computeTelemetryCrc(header, 14));
+
+  HAL_FLASH_Unlock();
+  if (HAL_FLASHEx_Erase(&erase, &sectorError) != HAL_OK)
+  {
+    TLOG("[flash_log::formatSector] Error! Erase of sector %lu failed", erase.Sector);
+    failed = 1;
+  }
+  for (i = 0; i < HEADER_LENGTH && !failed; i += 4)
+  {
+    if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, logSectors[index].address + i, getLe32(&header[i])) != HAL_OK)
+    {
+      TLOG("[flash_log::formatSector] Error! Header of sector %lu failed", erase.Sector);
+      failed = 1;
+    }
+  }
+  HAL_FLASH_Lock();
+
+  active = index;
+  activeSequence = sequence;
+  appendOffset = programOffset = HEADER_LENGTH;
+  stagingHead = stagingTail = 0;
+  lastTimestampMs = 0;
+  lastRangeMm = 0;
+}
+
+// FUNCTION      : switchSector
+// DESCRIPTION   :
+//    Programs what is left of the active sector and continues in the other
+//    sector, erasing its records.
+// PARAMETERS    : None
+// RETURNS       : None
+static void switchSector(void)
+{
+  padToWord();
+  programStaged(STAGING_SIZE / 4);
+
+  if (dumpRunning)
+  {
+    // The sector being dumped may be the one erased now
+    dumpFlags |= FLASH_LOG_DUMP_ABORTED;
+    dumpSectorsLeft = 1;
+    dumpOffset = dumpEnd;
+  }
+
+  formatSector(active ^ 1, activeSequence + 1);
+}
+
+// FUNCTION      : appendRecord
+// DESCRIPTION   :
+//    Adds the length and the CRC to a record payload and stages it.
+// PARAMETERS    :
+//    const uint8_t* payload : Payload.
+//    uint8_t length         : Length of the payload, MAX_PAYLOAD at most.
+// RETURNS       : None
+static void appendRecord(const uint8_t* payload, uint8_t length)
+{
+  uint8_t record[MAX_RECORD_LENGTH];
+
+  record[0] = length;
+  memcpy(&record[1], payload, length);
+  putLe16(&record[1 + length], computeTelemetryCrc(record, 1 + length));
+
+  stageBytes(record, length + RECORD_OVERHEAD);
+}
+
+// FUNCTION      : makeRoom
+// DESCRIPTION   :
+//    Checks that a record of any length fits, switching to the other
+//    sector when the active one is full.
+// PARAMETERS    : None
+// RETURNS       :
+//    uint8_t : 1 when the record can be appended, 0 when it is dropped.
+static uint8_t makeRoom(void)
+{
+  if (failed)
+  {
+    return 0;
+  }
+
+  if (appendOffset + MAX_RECORD_LENGTH + 3 > SECTOR_SIZE)
+  {
+    switchSector();
+  }
+
+  if (failed || STAGING_SIZE - (stagingHead - stagingTail) < MAX_RECORD_LENGTH + 3)
+  {
+    drops++;
+    return 0;
+  }
+
+  return 1;
+}
+
+// FUNCTION      : releaseDumpFrame
+// DESCRIPTION   : Called from the USART2 TX complete interrupt once a dump frame has been sent.
+// PARAMETERS    :
+//    const uint8_t* frame : The frame.
+// RETURNS       : None
+static void releaseDumpFrame(const uint8_t* frame)
+{
+  (void)frame;
+  dumpFrameBusy = 0;
+}
+
+// FUNCTION      : startDump
+// DESCRIPTION   :
+//    Programs the staged records and starts dumping the older sector, if
+//    it holds a log, then the active one.
+// PARAMETERS    : None
+// RETURNS       : None
+static void startDump(void)
+{
+  uint32_t sequence;
+
+  dumpRequested = 0;
+
+  padToWord();
+  programStaged(STAGING_SIZE / 4);
+
+  // Flash data read before it was programmed may still be in the data cache
+  __HAL_FLASH_DATA_CACHE_DISABLE();
+  __HAL_FLASH_DATA_CACHE_RESET();
+  __HAL_FLASH_DATA_CACHE_ENABLE();
+
+  if (readSectorHeader(active ^ 1, &sequence))
+  {
+    dumpSector = active ^ 1;
+    dumpSequence = sequence;
+    dumpEnd = findLogEnd(dumpSector);
+    dumpSectorsLeft = 2;
+  }
+  else
+  {
+    dumpSector = active;
+    dumpSequence = activeSequence;
+    dumpEnd = programOffset;
+    dumpSectorsLeft = 1;
+  }
+
+  dumpOffset = 0;
+  dumpFrames = 0;
+  dumpFlags = 0;
+  dumpRunning = 1;
+}
+
+// FUNCTION      : sendDumpFrame
+// DESCRIPTION   :
+//    Queues the next dump frame once the previous one has been sent, or
+//    the end frame after the last one.
+// PARAMETERS    : None
+// RETURNS       : None
+static void sendDumpFrame(void)
+{
+  uint32_t length = 0;
+  uint8_t frameLength;
+
+  if (dumpFrameBusy)
+  {
+    return;
+  }
+
+  if (dumpOffset >= dumpEnd && dumpSectorsLeft > 1)
+  {
+    dumpSectorsLeft--;
+    dumpSector = active;
+    dumpSequence = activeSequence;
+    dumpOffset = 0;
+    dumpEnd = programOffset;
+  }
+
+  if (dumpOffset >= dumpEnd)
+  {
+    dumpPayload[0] = FLASH_LOG_END_FRAME;
+    putLe16(&dumpPayload[1], dumpFrames);
+    putLe32(&dumpPayload[3], drops);
+    dumpPayload[7] = dumpFlags;
+    frameLength = buildTelemetryFrame(dumpPayload, END_LENGTH, dumpFrame);
+  }
+  else
+  {
+    length = dumpEnd - dumpOffset;
+    if (length > DUMP_CHUNK)
+    {
+      length = DUMP_CHUNK;
+    }
+
+    dumpPayload[0] = FLASH_LOG_DUMP_FRAME;
+    putLe32(&dumpPayload[1], dumpSequence);
+    putLe32(&dumpPayload[5], dumpOffset);
+    memcpy(&dumpPayload[DUMP_HEADER_LENGTH], (const uint8_t*)(logSectors[dumpSector].address + dumpOffset), length);
+    frameLength = buildTelemetryFrame(dumpPayload, DUMP_HEADER_LENGTH + length, dumpFrame);
+  }
+
+  dumpFrameBusy = 1;
+  if (port_tx_block(dumpFrame, frameLength, releaseDumpFrame) != HAL_OK)
+  {
+    // Try again on the next poll
+    dumpFrameBusy = 0;
+    return;
+  }
+
+  if (dumpOffset >= dumpEnd)
+  {
+    dumpRunning = 0;
+  }
+  else
+  {
+    dumpOffset += length;
+    dumpFrames++;
+  }
+}
+
+// FUNCTION      : HAL_UART_RxCpltCallback
+// DESCRIPTION   : A command byte has been received on USART2.
+// PARAMETERS    :
+//    UART_HandleTypeDef* huart : UART handle.
+// RETURNS       : None
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef* huart)
+{
+  if (huart->Instance != USART2)
+  {
+    return;
+  }
+
+  if (commandByte == FLASH_LOG_DUMP_COMMAND)
+  {
+    dumpRequested = 1;
+  }
+  listenFlashLogCommand();
+}
+
+#endif
+
+// FUNCTION      : initFlashLog
+// DESCRIPTION   :
+//    Finds the end of the log, or formats sector 6 on first use, and
+//    appends a session record, then listens for FLASH_LOG_DUMP_COMMAND.
+//    Call once after MX_USART2_UART_Init().
+// PARAMETERS    : None
+// RETURNS       : None
+void initFlashLog(void)
+{
+#if (FLASH_LOG_ENABLE == 1)
+  uint32_t sequence[NUM_OF_SECTORS];
+  uint8_t valid[NUM_OF_SECTORS];
+  uint8_t i;
+  uint32_t end;
+  uint8_t padding;
+  const uint8_t session = FLASH_LOG_SESSION;
+
+  for (i = 0; i < NUM_OF_SECTORS; i++)
+  {
+    valid[i] = readSectorHeader(i, &sequence[i]);
+  }
+
+  if (!valid[0] && !valid[1])
+  {
+    formatSector(0, 1);
+  }
+  else
+  {
+    active = (valid[1] && (!valid[0] || (int32_t)(sequence[1] - sequence[0]) > 0)) ? 1 : 0;
+    activeSequence = sequence[active];
+    end = findLogEnd(active);
+
+    // Continue from the start of the word holding the end, padded up to
+    // the end, so that walking the records lands on the next one
+    appendOffset = programOffset = end & ~3UL;
+    while (appendOffset < end)
+    {
+      padding = PADDING;
+      stageBytes(&padding, 1);
+    }
+  }
+
+  if (makeRoom())
+  {
+    lastTimestampMs = 0;
+    lastRangeMm = 0;
+    appendRecord(&session, 1);
+  }
+
+  listenFlashLogCommand();
+#endif
+}
+
+// FUNCTION      : listenFlashLogCommand
+// DESCRIPTION   :
+//    Starts receiving the next command byte on USART2 unless it is already
+//    receiving. Called by initFlashLog(), and from the receive complete and
+//    error interrupts of USART2. The interrupts are masked while the UART is
+//    locked, so that an interrupt never finds it locked by this call. An
+//    interrupt which cut into a transmission started by a task finds it
+//    locked itself; pollFlashLog() tries again then.
+// PARAMETERS    : None
+// RETURNS       : None
+void listenFlashLogCommand(void)
+{
+#if (FLASH_LOG_ENABLE == 1)
+  uint32_t primask;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  listenAgain = (huart2.RxState == HAL_UART_STATE_READY) &&
+                (HAL_UART_Receive_IT(&huart2, &commandByte, 1) != HAL_OK);
+  __set_PRIMASK(primask);
+#endif
+}
+
+// FUNCTION      : appendFlashLog
+// DESCRIPTION   :
+//    Appends the result of an exchange to the log. Only stages the record
+//    in RAM, except when a sector has to be erased.
+// PARAMETERS    :
+//    const TelemetryRecord* record : Result of the exchange.
+// RETURNS       : None
+void appendFlashLog(const TelemetryRecord* record)
+{
+#if (FLASH_LOG_ENABLE == 1)
+  uint8_t payload[MAX_PAYLOAD];
+  uint8_t length = 0;
+  const uint32_t timestampMs = HAL_GetTick();
+  int32_t rangeDelta;
+
+  if (!makeRoom())
+  {
+    return;
+  }
+
+  payload[length++] = FLASH_LOG_RANGE;
+  length += putVarint(&payload[length], timestampMs - lastTimestampMs);
+  payload[length++] = record->flags;
+  if (record->flags & TLM_FLAG_RANGE_VALID)
+  {
+    rangeDelta = record->rangeMm - lastRangeMm;
+    length += putVarint(&payload[length], ((uint32_t)rangeDelta << 1) ^ (uint32_t)(rangeDelta >> 31));
+    lastRangeMm = record->rangeMm;
+  }
+  lastTimestampMs = timestampMs;
+
+  appendRecord(payload, length);
+#else
+  (void)record;
+#endif
+}
+
+// FUNCTION      : pollFlashLog
+// DESCRIPTION   :
+//    Programs some of the staged records and runs the dump. Call again soon
+//    while it returns 1; takes about 0.15 ms.
+// PARAMETERS    : None
+// RETURNS       :
+//    uint8_t : 1 while words are staged or a dump is running, 0 otherwise.
+uint8_t pollFlashLog(void)
+{
+#if (FLASH_LOG_ENABLE == 1)
+  if (listenAgain)
+  {
+    listenFlashLogCommand();
+  }
+
+  if (dumpRequested && !dumpRunning)
+  {
+    startDump();
+  }
+
+  if (dumpRunning)
+  {
+    sendDumpFrame();
+  }
+
+  programStaged(WORDS_PER_POLL);
+
+  return dumpRequested || dumpRunning || (!failed && (stagingHead - stagingTail) >= 4);
+#else
+  return 0;
+#endif
+}
+
+// FUNCTION      : requestFlashLogDump
+// DESCRIPTION   : Starts a dump, as FLASH_LOG_DUMP_COMMAND does. Can be called from interrupts.
+// PARAMETERS    : None
+// RETURNS       : None
+void requestFlashLogDump(void)
+{
+#if (FLASH_LOG_ENABLE == 1)
+  dumpRequested = 1;
+#endif
+}
+
+// FUNCTION      : getFlashLogDrops
+// DESCRIPTION   : Number of records dropped because the staging buffer was full.
+// PARAMETERS    : None
+// RETURNS       :
+//    uint32_t : Dropped records since reset.
+uint32_t getFlashLogDrops(void)
+{
+#if (FLASH_LOG_ENABLE == 1)
+  return drops;
+#else
+  return 0;
+#endif
+}
@@ -288,3 +288,37 @@ const uint8_t c_chAlarm88[8] = //alram
 };
 
 
+
+/**
+  * @brief  Returns one row of a packed glyph as a bit mask, bit 15 is the leftmost column.
+  *         Rows outside the bounding box of the glyph are 0 without touching the bitmap.
+  * @param  ptFont: packed font
+  * @param  chChr: character, 0 for characters missing from the font
+  * @param  chRow: row within the cell, 0 is the top
+  * @retval Set pixels of the row
+**/
+uint16_t font_glyph_row(const font_packed_t *ptFont, uint8_t chChr, uint8_t chRow)
+{
+	const uint8_t *pchGlyph;
+	uint8_t chX0, chWidth;
+	uint16_t hwBit;
+	uint32_t wBits;
+
+	if (chChr < ptFont->chFirst || chChr - ptFont->chFirst >= ptFont->chCount) {
+		return 0;
+	}
+	pchGlyph = &ptFont->pchData[ptFont->phwOffset[chChr - ptFont->chFirst]];
+	if (chRow < pchGlyph[1] || chRow - pchGlyph[1] >= pchGlyph[2]) {
+		return 0;
+	}
+	chX0 = pchGlyph[0] >> 4;
+	chWidth = (pchGlyph[0] & 0x0F) + 1;
+	hwBit = (uint16_t)(chRow - pchGlyph[1]) * chWidth;
+
+	//a row of up to 16 bits spans at most 3 bytes; the tables are padded so this never reads past the end
+	pchGlyph += 3 + hwBit / 8;
+	wBits = ((uint32_t)pchGlyph[0] << 24) | ((uint32_t)pchGlyph[1] << 16) | ((uint32_t)pchGlyph[2] << 8);
+	wBits = (wBits << (hwBit % 8)) & (0xFFFFFFFFu << (32 - chWidth));
+
+	return (uint16_t)(wBits >> (16 + chX0));
+}
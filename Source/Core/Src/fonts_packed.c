@@ -0,0 +1,465 @@
+/* Generated by Tools/font_pack.py from the arrays in fonts.c, do not edit. */
+#include <stdint.h>
+#include "fonts.h"
+
+static const uint16_t c_hwFont1206Offset[95] = {
+	0,/*" ",0*/
+	3,/*"!",1*/
+	7,/*""",2*/
+	12,/*"#",3*/
+	21,/*"$",4*/
+	31,/*"%",5*/
+	40,/*"&",6*/
+	49,/*"'",7*/
+	53,/*"(",8*/
+	60,/*")",9*/
+	67,/*"\x2A",10*/
+	74,/*"+",11*/
+	82,/*",",12*/
+	86,/*"-",13*/
+	90,/*".",14*/
+	94,/*"\x2F",15*/
+	104,/*"0",16*/
+	112,/*"1",17*/
+	118,/*"2",18*/
+	126,/*"3",19*/
+	134,/*"4",20*/
+	142,/*"5",21*/
+	150,/*"6",22*/
+	158,/*"7",23*/
+	166,/*"8",24*/
+	174,/*"9",25*/
+	182,/*":",26*/
+	186,/*";",27*/
+	190,/*"<",28*/
+	199,/*"=",29*/
+	205,/*">",30*/
+	214,/*"?",31*/
+	222,/*"@",32*/
+	230,/*"A",33*/
+	239,/*"B",34*/
+	247,/*"C",35*/
+	255,/*"D",36*/
+	263,/*"E",37*/
+	271,/*"F",38*/
+	279,/*"G",39*/
+	288,/*"H",40*/
+	297,/*"I",41*/
+	305,/*"J",42*/
+	315,/*"K",43*/
+	324,/*"L",44*/
+	333,/*"M",45*/
+	341,/*"N",46*/
+	350,/*"O",47*/
+	358,/*"P",48*/
+	366,/*"Q",49*/
+	375,/*"R",50*/
+	384,/*"S",51*/
+	392,/*"T",52*/
+	400,/*"U",53*/
+	409,/*"V",54*/
+	418,/*"W",55*/
+	426,/*"X",56*/
+	434,/*"Y",57*/
+	442,/*"Z",58*/
+	450,/*"[",59*/
+	457,/*"\x5C",60*/
+	465,/*"]",61*/
+	472,/*"^",62*/
+	476,/*"_",63*/
+	480,/*"`",64*/
+	484,/*"a",65*/
+	491,/*"b",66*/
+	499,/*"c",67*/
+	505,/*"d",68*/
+	513,/*"e",69*/
+	519,/*"f",70*/
+	527,/*"g",71*/
+	535,/*"h",72*/
+	544,/*"i",73*/
+	550,/*"j",74*/
+	558,/*"k",75*/
+	567,/*"l",76*/
+	575,/*"m",77*/
+	582,/*"n",78*/
+	589,/*"o",79*/
+	595,/*"p",80*/
+	603,/*"q",81*/
+	611,/*"r",82*/
+	618,/*"s",83*/
+	624,/*"t",84*/
+	631,/*"u",85*/
+	638,/*"v",86*/
+	645,/*"w",87*/
+	652,/*"x",88*/
+	659,/*"y",89*/
+	668,/*"z",90*/
+	674,/*"{",91*/
+	681,/*"|",92*/
+	686,/*"}",93*/
+	693,/*"~",94*/
+};
+
+static const uint8_t c_chFont1206Packed[701] = {
+	0x00,0x00,0x00,/*" ",0*/
+	0x20,0x02,0x08,0xFD,/*"!",1*/
+	0x13,0x01,0x03,0x5A,0xA0,/*""",2*/
+	0x05,0x02,0x08,0x28,0xAF,0xCA,0x53,0xF5,0x14,/*"#",3*/
+	0x04,0x01,0x0A,0x23,0xEB,0x46,0x18,0xB5,0xF1,0x00,/*"$",4*/
+	0x05,0x02,0x08,0x4A,0xAB,0x14,0x28,0xD5,0x52,/*"%",5*/
+	0x05,0x02,0x08,0x21,0x45,0x1E,0xAA,0xA9,0x1B,/*"&",6*/
+	0x01,0x01,0x03,0x58,/*"'",7*/
+	0x32,0x01,0x0A,0x2A,0x49,0x24,0x44,/*"(",8*/
+	0x12,0x01,0x0A,0x88,0x92,0x49,0x50,/*")",9*/
+	0x04,0x03,0x06,0x25,0x5C,0xEA,0x90,/*"\x2A",10*/
+	0x04,0x02,0x07,0x21,0x09,0xF2,0x10,0x80,/*"+",11*/
+	0x01,0x09,0x03,0x58,/*",",12*/
+	0x04,0x05,0x01,0xF8,/*"-",13*/
+	0x10,0x09,0x01,0x80,/*".",14*/
+	0x04,0x01,0x0A,0x08,0x84,0x22,0x11,0x08,0x44,0x00,/*"\x2F",15*/
+	0x04,0x02,0x08,0x74,0x63,0x18,0xC6,0x2E,/*"0",16*/
+	0x12,0x02,0x08,0x59,0x24,0x97,/*"1",17*/
+	0x04,0x02,0x08,0x74,0x62,0x22,0x22,0x1F,/*"2",18*/
+	0x04,0x02,0x08,0x74,0x42,0x60,0x86,0x2E,/*"3",19*/
+	0x04,0x02,0x08,0x11,0x94,0xA9,0x3C,0x43,/*"4",20*/
+	0x04,0x02,0x08,0xFC,0x21,0xE0,0x86,0x2E,/*"5",21*/
+	0x04,0x02,0x08,0x74,0xA1,0xE8,0xC6,0x2E,/*"6",22*/
+	0x04,0x02,0x08,0xFC,0x84,0x42,0x10,0x84,/*"7",23*/
+	0x04,0x02,0x08,0x74,0x62,0xE8,0xC6,0x2E,/*"8",24*/
+	0x04,0x02,0x08,0x74,0x63,0x17,0x85,0x2E,/*"9",25*/
+	0x20,0x04,0x06,0x84,/*":",26*/
+	0x20,0x05,0x06,0x8C,/*";",27*/
+	0x14,0x01,0x09,0x08,0x88,0x88,0x20,0x82,0x08,/*"<",28*/
+	0x04,0x04,0x04,0xF8,0x01,0xF0,/*"=",29*/
+	0x14,0x01,0x09,0x82,0x08,0x20,0x88,0x88,0x80,/*">",30*/
+	0x04,0x02,0x08,0x74,0x62,0x22,0x10,0x04,/*"?",31*/
+	0x04,0x02,0x08,0x74,0x67,0x5A,0xDE,0x0F,/*"@",32*/
+	0x05,0x02,0x08,0x20,0x83,0x14,0x51,0xE4,0xB3,/*"A",33*/
+	0x04,0x02,0x08,0xF2,0x52,0xE4,0xA5,0x3E,/*"B",34*/
+	0x04,0x02,0x08,0x7C,0x61,0x08,0x42,0x2E,/*"C",35*/
+	0x04,0x02,0x08,0xF2,0x52,0x94,0xA5,0x3E,/*"D",36*/
+	0x04,0x02,0x08,0xFA,0x54,0xE5,0x21,0x3F,/*"E",37*/
+	0x04,0x02,0x08,0xFA,0x54,0xE5,0x21,0x1C,/*"F",38*/
+	0x05,0x02,0x08,0x39,0x28,0x20,0x9E,0x24,0x8C,/*"G",39*/
+	0x05,0x02,0x08,0xCD,0x24,0x9E,0x49,0x24,0xB3,/*"H",40*/
+	0x04,0x02,0x08,0xF9,0x08,0x42,0x10,0x9F,/*"I",41*/
+	0x05,0x02,0x09,0x7C,0x41,0x04,0x10,0x41,0x24,0xE0,/*"J",42*/
+	0x05,0x02,0x08,0xED,0x25,0x18,0x51,0x44,0xBB,/*"K",43*/
+	0x05,0x02,0x08,0xE1,0x04,0x10,0x41,0x04,0x7F,/*"L",44*/
+	0x04,0x02,0x08,0xDE,0xF7,0xBA,0xD6,0xB5,/*"M",45*/
+	0x05,0x02,0x08,0xDD,0x26,0x9A,0x59,0x64,0xBA,/*"N",46*/
+	0x04,0x02,0x08,0x74,0x63,0x18,0xC6,0x2E,/*"O",47*/
+	0x04,0x02,0x08,0xF2,0x52,0xE4,0x21,0x1C,/*"P",48*/
+	0x04,0x02,0x09,0x74,0x63,0x18,0xF6,0x6E,0x18,/*"Q",49*/
+	0x05,0x02,0x08,0xF1,0x24,0x9C,0x51,0x24,0xBB,/*"R",50*/
+	0x04,0x02,0x08,0x7C,0x60,0xC1,0x06,0x3E,/*"S",51*/
+	0x04,0x02,0x08,0xFD,0x48,0x42,0x10,0x8E,/*"T",52*/
+	0x05,0x02,0x08,0xCD,0x24,0x92,0x49,0x24,0x8C,/*"U",53*/
+	0x05,0x02,0x08,0xCD,0x24,0x94,0x50,0xC2,0x08,/*"V",54*/
+	0x04,0x02,0x08,0xAD,0x6A,0xE5,0x29,0x4A,/*"W",55*/
+	0x04,0x02,0x08,0xDA,0x94,0x42,0x29,0x5B,/*"X",56*/
+	0x04,0x02,0x08,0xDA,0x94,0x42,0x10,0x8E,/*"Y",57*/
+	0x04,0x02,0x08,0xFC,0x84,0x42,0x21,0x3F,/*"Z",58*/
+	0x22,0x01,0x0A,0xF2,0x49,0x24,0x9C,/*"[",59*/
+	0x13,0x01,0x09,0x88,0x84,0x42,0x22,0x10,/*"\x5C",60*/
+	0x12,0x01,0x0A,0xE4,0x92,0x49,0x3C,/*"]",61*/
+	0x12,0x01,0x02,0x54,/*"^",62*/
+	0x05,0x0B,0x01,0xFC,/*"_",63*/
+	0x20,0x01,0x01,0x80,/*"`",64*/
+	0x14,0x05,0x05,0x64,0x9D,0x27,0x80,/*"a",65*/
+	0x04,0x02,0x08,0xC2,0x10,0xE4,0xA5,0x2E,/*"b",66*/
+	0x13,0x05,0x05,0x79,0x88,0x70,/*"c",67*/
+	0x14,0x02,0x08,0x30,0x84,0xE9,0x4A,0x4F,/*"d",68*/
+	0x13,0x05,0x05,0x69,0xF8,0x70,/*"e",69*/
+	0x14,0x02,0x08,0x3A,0x11,0xE4,0x21,0x1E,/*"f",70*/
+	0x14,0x05,0x07,0x7C,0x99,0x0F,0x45,0xC0,/*"g",71*/
+	0x05,0x02,0x08,0xC1,0x04,0x1C,0x49,0x24,0xBB,/*"h",72*/
+	0x12,0x02,0x08,0x40,0x64,0x97,/*"i",73*/
+	0x03,0x02,0x0A,0x10,0x03,0x11,0x11,0x1E,/*"j",74*/
+	0x05,0x02,0x08,0xC1,0x04,0x17,0x51,0xC4,0xBB,/*"k",75*/
+	0x04,0x02,0x08,0xE1,0x08,0x42,0x10,0x9F,/*"l",76*/
+	0x04,0x05,0x05,0xF5,0x6B,0x5A,0x80,/*"m",77*/
+	0x05,0x05,0x05,0xF1,0x24,0x92,0xEC,/*"n",78*/
+	0x13,0x05,0x05,0x69,0x99,0x60,/*"o",79*/
+	0x04,0x05,0x07,0xF2,0x52,0x97,0x23,0x80,/*"p",80*/
+	0x14,0x05,0x07,0x74,0xA5,0x27,0x08,0xE0,/*"q",81*/
+	0x04,0x05,0x05,0xDB,0x10,0x8E,0x00,/*"r",82*/
+	0x13,0x05,0x05,0xF8,0x61,0xF0,/*"s",83*/
+	0x13,0x03,0x07,0x44,0xE4,0x44,0x30,/*"t",84*/
+	0x05,0x05,0x05,0xD9,0x24,0x92,0x3C,/*"u",85*/
+	0x05,0x05,0x05,0xED,0x25,0x0C,0x20,/*"v",86*/
+	0x04,0x05,0x05,0xAD,0x5C,0xA5,0x00,/*"w",87*/
+	0x04,0x05,0x05,0xDA,0x88,0xAD,0x80,/*"x",88*/
+	0x05,0x05,0x07,0xED,0x25,0x0C,0x20,0x8C,0x00,/*"y",89*/
+	0x13,0x05,0x05,0xF2,0x44,0xF0,/*"z",90*/
+	0x22,0x01,0x0A,0x69,0x28,0x92,0x4C,/*"{",91*/
+	0x30,0x00,0x0C,0xFF,0xF0,/*"|",92*/
+	0x12,0x01,0x0A,0xC9,0x22,0x92,0x58,/*"}",93*/
+	0x05,0x00,0x03,0x42,0x91,0x80,/*"~",94*/
+	0x00,0x00,/*padding*/
+};
+
+const font_packed_t c_tFont1206 = {6, 12, 0x20, 95, c_hwFont1206Offset, c_chFont1206Packed};
+
+static const uint16_t c_hwFont1608Offset[95] = {
+	0,/*" ",0*/
+	3,/*"!",1*/
+	9,/*""",2*/
+	15,/*"#",3*/
+	28,/*"$",4*/
+	40,/*"%",5*/
+	53,/*"&",6*/
+	67,/*"'",7*/
+	72,/*"(",8*/
+	82,/*")",9*/
+	92,/*"\x2A",10*/
+	102,/*"+",11*/
+	113,/*",",12*/
+	118,/*"-",13*/
+	122,/*".",14*/
+	126,/*"\x2F",15*/
+	141,/*"0",16*/
+	153,/*"1",17*/
+	163,/*"2",18*/
+	175,/*"3",19*/
+	187,/*"4",20*/
+	199,/*"5",21*/
+	211,/*"6",22*/
+	223,/*"7",23*/
+	235,/*"8",24*/
+	247,/*"9",25*/
+	259,/*":",26*/
+	264,/*";",27*/
+	270,/*"<",28*/
+	282,/*"=",29*/
+	290,/*">",30*/
+	302,/*"?",31*/
+	314,/*"@",32*/
+	327,/*"A",33*/
+	341,/*"B",34*/
+	354,/*"C",35*/
+	367,/*"D",36*/
+	380,/*"E",37*/
+	393,/*"F",38*/
+	406,/*"G",39*/
+	419,/*"H",40*/
+	433,/*"I",41*/
+	443,/*"J",42*/
+	458,/*"K",43*/
+	471,/*"L",44*/
+	484,/*"M",45*/
+	497,/*"N",46*/
+	511,/*"O",47*/
+	524,/*"P",48*/
+	537,/*"Q",49*/
+	551,/*"R",50*/
+	565,/*"S",51*/
+	577,/*"T",52*/
+	590,/*"U",53*/
+	604,/*"V",54*/
+	618,/*"W",55*/
+	631,/*"X",56*/
+	645,/*"Y",57*/
+	658,/*"Z",58*/
+	671,/*"[",59*/
+	681,/*"\x5C",60*/
+	695,/*"]",61*/
+	705,/*"^",62*/
+	710,/*"_",63*/
+	714,/*"`",64*/
+	718,/*"a",65*/
+	728,/*"b",66*/
+	741,/*"c",67*/
+	750,/*"d",68*/
+	763,/*"e",69*/
+	772,/*"f",70*/
+	785,/*"g",71*/
+	795,/*"h",72*/
+	809,/*"i",73*/
+	819,/*"j",74*/
+	831,/*"k",75*/
+	844,/*"l",76*/
+	854,/*"m",77*/
+	864,/*"n",78*/
+	874,/*"o",79*/
+	883,/*"p",80*/
+	894,/*"q",81*/
+	905,/*"r",82*/
+	915,/*"s",83*/
+	924,/*"t",84*/
+	933,/*"u",85*/
+	943,/*"v",86*/
+	953,/*"w",87*/
+	963,/*"x",88*/
+	972,/*"y",89*/
+	984,/*"z",90*/
+	993,/*"{",91*/
+	1003,/*"|",92*/
+	1008,/*"}",93*/
+	1018,/*"~",94*/
+};
+
+static const uint8_t c_chFont1608Packed[1026] = {
+	0x00,0x00,0x00,/*" ",0*/
+	0x31,0x03,0x0B,0xAA,0xA8,0x3C,/*"!",1*/
+	0x15,0x01,0x04,0x25,0xB4,0xA4,/*""",2*/
+	0x06,0x03,0x0B,0x24,0x48,0x97,0xF4,0x89,0x12,0x7F,0x48,0x91,0x20,/*"#",3*/
+	0x14,0x02,0x0E,0x23,0xAB,0x5A,0x30,0xC5,0x2D,0x6A,0xE2,0x10,/*"$",4*/
+	0x06,0x03,0x0B,0x45,0x4A,0xA5,0x4A,0x8A,0x86,0x95,0x2A,0x55,0x10,/*"%",5*/
+	0x07,0x03,0x0B,0x30,0x48,0x48,0x48,0x50,0x6E,0xA4,0x94,0x88,0x89,0x76,/*"&",6*/
+	0x02,0x01,0x04,0x6C,0xE0,/*"'",7*/
+	0x33,0x01,0x0E,0x12,0x44,0x88,0x88,0x88,0x44,0x21,/*"(",8*/
+	0x13,0x01,0x0E,0x84,0x22,0x11,0x11,0x11,0x22,0x48,/*")",9*/
+	0x06,0x04,0x08,0x10,0x23,0x59,0xC3,0x9A,0xC4,0x08,/*"\x2A",10*/
+	0x06,0x04,0x09,0x10,0x20,0x40,0x8F,0xE2,0x04,0x08,0x10,/*"+",11*/
+	0x02,0x0C,0x04,0x6C,0xE0,/*",",12*/
+	0x16,0x08,0x01,0xFE,/*"-",13*/
+	0x11,0x0C,0x02,0xF0,/*".",14*/
+	0x16,0x02,0x0D,0x02,0x08,0x10,0x40,0x82,0x04,0x10,0x20,0x81,0x04,0x08,0x00,/*"\x2F",15*/
+	0x15,0x03,0x0B,0x31,0x28,0x61,0x86,0x18,0x61,0x85,0x23,0x00,/*"0",16*/
+	0x14,0x03,0x0B,0x27,0x08,0x42,0x10,0x84,0x21,0x3E,/*"1",17*/
+	0x15,0x03,0x0B,0x7A,0x18,0x61,0x08,0x21,0x08,0x42,0x1F,0xC0,/*"2",18*/
+	0x15,0x03,0x0B,0x7A,0x18,0x42,0x30,0x20,0x41,0x86,0x27,0x00,/*"3",19*/
+	0x15,0x03,0x0B,0x08,0x62,0x92,0x4A,0x28,0xBF,0x08,0x23,0xC0,/*"4",20*/
+	0x15,0x03,0x0B,0xFE,0x08,0x20,0xB3,0x20,0x41,0x86,0x27,0x00,/*"5",21*/
+	0x15,0x03,0x0B,0x39,0x28,0x20,0xB3,0x28,0x61,0x85,0x23,0x00,/*"6",22*/
+	0x15,0x03,0x0B,0xFE,0x28,0x84,0x10,0x82,0x08,0x20,0x82,0x00,/*"7",23*/
+	0x15,0x03,0x0B,0x7A,0x18,0x61,0x48,0xC4,0xA1,0x86,0x17,0x80,/*"8",24*/
+	0x15,0x03,0x0B,0x31,0x28,0x61,0x85,0x33,0x41,0x05,0x27,0x00,/*"9",25*/
+	0x31,0x06,0x08,0xF0,0x0F,/*":",26*/
+	0x21,0x07,0x09,0x40,0x05,0x80,/*";",27*/
+	0x15,0x03,0x0B,0x04,0x21,0x08,0x42,0x04,0x08,0x10,0x20,0x40,/*"<",28*/
+	0x06,0x06,0x05,0xFE,0x00,0x00,0x0F,0xE0,/*"=",29*/
+	0x15,0x03,0x0B,0x81,0x02,0x04,0x08,0x10,0x84,0x21,0x08,0x00,/*">",30*/
+	0x15,0x03,0x0B,0x7A,0x18,0x71,0x04,0x21,0x04,0x00,0xC3,0x00,/*"?",31*/
+	0x06,0x03,0x0B,0x38,0x89,0x6D,0x5A,0xB5,0x6A,0xDA,0x42,0x88,0xE0,/*"@",32*/
+	0x07,0x03,0x0B,0x10,0x10,0x18,0x28,0x28,0x24,0x3C,0x44,0x42,0x42,0xE7,/*"A",33*/
+	0x06,0x03,0x0B,0xF8,0x89,0x12,0x27,0x88,0x90,0xA1,0x42,0x8B,0xE0,/*"B",34*/
+	0x06,0x03,0x0B,0x3E,0x85,0x0C,0x08,0x10,0x20,0x40,0x42,0x88,0xE0,/*"C",35*/
+	0x06,0x03,0x0B,0xF8,0x89,0x0A,0x14,0x28,0x50,0xA1,0x42,0x8B,0xE0,/*"D",36*/
+	0x06,0x03,0x0B,0xFC,0x85,0x22,0x47,0x89,0x12,0x20,0x42,0x87,0xF0,/*"E",37*/
+	0x06,0x03,0x0B,0xFC,0x85,0x22,0x47,0x89,0x12,0x20,0x40,0x83,0x80,/*"F",38*/
+	0x06,0x03,0x0B,0x3C,0x89,0x14,0x08,0x10,0x23,0xC2,0x44,0x88,0xE0,/*"G",39*/
+	0x07,0x03,0x0B,0xE7,0x42,0x42,0x42,0x42,0x7E,0x42,0x42,0x42,0x42,0xE7,/*"H",40*/
+	0x14,0x03,0x0B,0xF9,0x08,0x42,0x10,0x84,0x21,0x3E,/*"I",41*/
+	0x06,0x03,0x0D,0x3E,0x10,0x20,0x40,0x81,0x02,0x04,0x08,0x10,0x24,0x4F,0x00,/*"J",42*/
+	0x06,0x03,0x0B,0xEE,0x89,0x22,0x87,0x0A,0x12,0x24,0x44,0x8B,0xB8,/*"K",43*/
+	0x06,0x03,0x0B,0xE0,0x81,0x02,0x04,0x08,0x10,0x20,0x40,0x87,0xF8,/*"L",44*/
+	0x06,0x03,0x0B,0xEE,0xD9,0xB3,0x66,0xCA,0x95,0x2A,0x54,0xAB,0x58,/*"M",45*/
+	0x07,0x03,0x0B,0xC7,0x62,0x62,0x52,0x52,0x4A,0x4A,0x4A,0x46,0x46,0xE2,/*"N",46*/
+	0x06,0x03,0x0B,0x38,0x8A,0x0C,0x18,0x30,0x60,0xC1,0x82,0x88,0xE0,/*"O",47*/
+	0x06,0x03,0x0B,0xFC,0x85,0x0A,0x14,0x2F,0x90,0x20,0x40,0x83,0x80,/*"P",48*/
+	0x06,0x03,0x0C,0x38,0x8A,0x0C,0x18,0x30,0x60,0xD9,0xCA,0x98,0xE0,0x30,/*"Q",49*/
+	0x07,0x03,0x0B,0xFC,0x42,0x42,0x42,0x7C,0x48,0x48,0x44,0x44,0x42,0xE3,/*"R",50*/
+	0x15,0x03,0x0B,0x7E,0x18,0x60,0x40,0xC0,0x81,0x86,0x1F,0x80,/*"S",51*/
+	0x06,0x03,0x0B,0xFF,0x24,0x40,0x81,0x02,0x04,0x08,0x10,0x20,0xE0,/*"T",52*/
+	0x07,0x03,0x0B,0xE7,0x42,0x42,0x42,0x42,0x42,0x42,0x42,0x42,0x42,0x3C,/*"U",53*/
+	0x07,0x03,0x0B,0xE7,0x42,0x42,0x44,0x24,0x24,0x28,0x28,0x18,0x10,0x10,/*"V",54*/
+	0x06,0x03,0x0B,0xD7,0x26,0x4C,0x99,0x35,0x6A,0xB6,0x44,0x89,0x10,/*"W",55*/
+	0x07,0x03,0x0B,0xE7,0x42,0x24,0x24,0x18,0x18,0x18,0x24,0x24,0x42,0xE7,/*"X",56*/
+	0x06,0x03,0x0B,0xEE,0x89,0x11,0x42,0x82,0x04,0x08,0x10,0x20,0xE0,/*"Y",57*/
+	0x06,0x03,0x0B,0x7F,0x08,0x10,0x40,0x82,0x08,0x10,0x42,0x87,0xF0,/*"Z",58*/
+	0x33,0x01,0x0E,0xF8,0x88,0x88,0x88,0x88,0x88,0x8F,/*"[",59*/
+	0x15,0x02,0x0E,0x82,0x04,0x10,0x20,0x82,0x04,0x10,0x20,0x82,0x04,0x10,/*"\x5C",60*/
+	0x13,0x01,0x0E,0xF1,0x11,0x11,0x11,0x11,0x11,0x1F,/*"]",61*/
+	0x24,0x01,0x02,0x74,0x40,/*"^",62*/
+	0x07,0x0F,0x01,0xFF,/*"_",63*/
+	0x12,0x01,0x02,0xC4,/*"`",64*/
+	0x16,0x07,0x07,0x79,0x08,0xF2,0x28,0x50,0x9F,0x80,/*"a",65*/
+	0x06,0x03,0x0B,0xC0,0x81,0x02,0x05,0x8C,0x90,0xA1,0x42,0xC9,0x60,/*"b",66*/
+	0x15,0x07,0x07,0x39,0x18,0x20,0x81,0x13,0x80,/*"c",67*/
+	0x16,0x03,0x0B,0x0C,0x08,0x10,0x23,0xC8,0xA1,0x42,0x84,0x98,0xD8,/*"d",68*/
+	0x15,0x07,0x07,0x7A,0x1F,0xE0,0x82,0x17,0x80,/*"e",69*/
+	0x16,0x03,0x0B,0x1E,0x44,0x81,0x0F,0xC4,0x08,0x10,0x20,0x43,0xE0,/*"f",70*/
+	0x15,0x07,0x09,0x7E,0x28,0x9C,0x81,0xE8,0x61,0x78,/*"g",71*/
+	0x07,0x03,0x0B,0xC0,0x40,0x40,0x40,0x5C,0x62,0x42,0x42,0x42,0x42,0xE7,/*"h",72*/
+	0x14,0x03,0x0B,0x63,0x00,0x0E,0x10,0x84,0x21,0x3E,/*"i",73*/
+	0x14,0x03,0x0D,0x18,0xC0,0x03,0x84,0x21,0x08,0x43,0x1F,0x00,/*"j",74*/
+	0x06,0x03,0x0B,0xC0,0x81,0x02,0x04,0xE9,0x14,0x34,0x48,0x8B,0xB8,/*"k",75*/
+	0x14,0x03,0x0B,0xE1,0x08,0x42,0x10,0x84,0x21,0x3E,/*"l",76*/
+	0x07,0x07,0x07,0xFE,0x49,0x49,0x49,0x49,0x49,0xED,/*"m",77*/
+	0x07,0x07,0x07,0xDC,0x62,0x42,0x42,0x42,0x42,0xE7,/*"n",78*/
+	0x15,0x07,0x07,0x7A,0x18,0x61,0x86,0x17,0x80,/*"o",79*/
+	0x06,0x07,0x09,0xD8,0xC9,0x0A,0x14,0x28,0x9E,0x20,0xE0,/*"p",80*/
+	0x16,0x07,0x09,0x3C,0x8A,0x14,0x28,0x48,0x8F,0x02,0x0E,/*"q",81*/
+	0x06,0x07,0x07,0xEE,0x64,0x81,0x02,0x04,0x3E,0x00,/*"r",82*/
+	0x15,0x07,0x07,0x7E,0x18,0x1E,0x06,0x1F,0x80,/*"s",83*/
+	0x14,0x05,0x09,0x21,0x3E,0x42,0x10,0x84,0x18,/*"t",84*/
+	0x07,0x07,0x07,0xC6,0x42,0x42,0x42,0x42,0x46,0x3B,/*"u",85*/
+	0x07,0x07,0x07,0xE7,0x42,0x24,0x24,0x28,0x10,0x10,/*"v",86*/
+	0x07,0x07,0x07,0xD7,0x92,0x92,0xAA,0xAA,0x44,0x44,/*"w",87*/
+	0x15,0x07,0x07,0xDD,0x23,0x0C,0x31,0x2E,0xC0,/*"x",88*/
+	0x07,0x07,0x09,0xE7,0x42,0x24,0x24,0x28,0x18,0x10,0x10,0xE0,/*"y",89*/
+	0x15,0x07,0x07,0xFE,0x21,0x08,0x21,0x1F,0xC0,/*"z",90*/
+	0x43,0x01,0x0E,0x34,0x44,0x44,0x84,0x44,0x44,0x43,/*"{",91*/
+	0x40,0x00,0x10,0xFF,0xFF,/*"|",92*/
+	0x13,0x01,0x0E,0xC2,0x22,0x22,0x12,0x22,0x22,0x2C,/*"}",93*/
+	0x16,0x00,0x03,0x61,0x32,0x18,/*"~",94*/
+	0x00,0x00,/*padding*/
+};
+
+const font_packed_t c_tFont1608 = {8, 16, 0x20, 95, c_hwFont1608Offset, c_chFont1608Packed};
+
+static const uint16_t c_hwFont1612Offset[11] = {
+	0,/*"0",0*/
+	24,/*"1",1*/
+	33,/*"2",2*/
+	57,/*"3",3*/
+	81,/*"4",4*/
+	105,/*"5",5*/
+	129,/*"6",6*/
+	153,/*"7",7*/
+	177,/*"8",8*/
+	201,/*"9",9*/
+	225,/*":",10*/
+};
+
+static const uint8_t c_chFont1612Packed[233] = {
+	0x1D,0x02,0x0C,0xFF,0xFF,0xFF,0xFC,0x00,0xF0,0x03,0xC0,0x0F,0x00,0x3C,0x00,0xF0,0x03,0xC0,0x0F,0x00,0x3F,0xFF,0xFF,0xFF,/*"0",0*/
+	0x73,0x02,0x0C,0xFF,0x33,0x33,0x33,0x33,0x33,/*"1",1*/
+	0x1D,0x02,0x0C,0xFF,0xFF,0xFF,0xFC,0x00,0xC0,0x03,0x00,0x0F,0xFF,0xFF,0xFF,0xF0,0x00,0xC0,0x03,0x00,0x0F,0xFF,0xFF,0xFF,/*"2",2*/
+	0x1D,0x02,0x0C,0xFF,0xFF,0xFF,0xFC,0x00,0xC0,0x03,0x00,0x0C,0xFF,0xF3,0xFF,0xC0,0x03,0x00,0x0F,0x00,0x3F,0xFF,0xFF,0xFF,/*"3",3*/
+	0x1D,0x02,0x0C,0xC0,0x0F,0x00,0x3C,0x00,0xF0,0x03,0xC0,0x0F,0xFF,0xFF,0xFF,0xC0,0x03,0x00,0x0C,0x00,0x30,0x00,0xC0,0x03,/*"4",4*/
+	0x1D,0x02,0x0C,0xFF,0xFF,0xFF,0xFC,0x00,0x30,0x00,0xC0,0x03,0xFF,0xFF,0xFF,0xC0,0x03,0xC0,0x0F,0x00,0x3F,0xFF,0xFF,0xFF,/*"5",5*/
+	0x1D,0x02,0x0C,0xFF,0xFF,0xFF,0xFC,0x00,0x30,0x00,0xC0,0x03,0xFF,0xFF,0xFF,0xC0,0x03,0x00,0x0F,0x00,0x3F,0xFF,0xFF,0xFF,/*"6",6*/
+	0x1D,0x02,0x0C,0xFF,0xFF,0xFF,0xFC,0x00,0xC0,0x03,0x00,0x0C,0x00,0x30,0x00,0xC0,0x03,0x00,0x0C,0x00,0x30,0x00,0xC0,0x03,/*"7",7*/
+	0x1D,0x02,0x0C,0xFF,0xFF,0xFF,0xFC,0x00,0xF0,0x03,0xC0,0x0F,0xFF,0xFF,0xFF,0xF0,0x03,0xC0,0x0F,0x00,0x3F,0xFF,0xFF,0xFF,/*"8",8*/
+	0x1D,0x02,0x0C,0xFF,0xFF,0xFF,0xFC,0x00,0xF0,0x03,0xC0,0x0F,0xFF,0xFF,0xFF,0xC0,0x03,0x00,0x0F,0x00,0x3F,0xFF,0xFF,0xFF,/*"9",9*/
+	0x71,0x03,0x09,0xF0,0x03,0xC0,/*":",10*/
+	0x00,0x00,/*padding*/
+};
+
+const font_packed_t c_tFont1612 = {16, 16, 0x30, 11, c_hwFont1612Offset, c_chFont1612Packed};
+
+static const uint16_t c_hwFont3216Offset[11] = {
+	0,/*"0",0*/
+	45,/*"1",1*/
+	62,/*"2",2*/
+	107,/*"3",3*/
+	152,/*"4",4*/
+	197,/*"5",5*/
+	242,/*"6",6*/
+	287,/*"7",7*/
+	332,/*"8",8*/
+	377,/*"9",9*/
+	422,/*":",10*/
+};
+
+static const uint8_t c_chFont3216Packed[445] = {
+	0x2B,0x02,0x1C,0xFF,0xFF,0xFF,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xFF,0xFF,0xFF,/*"0",0*/
+	0x63,0x02,0x1C,0xFF,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,/*"1",1*/
+	0x2B,0x02,0x1C,0xFF,0xFF,0xFF,0xC0,0x3C,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x3F,0xFF,0xFF,0xFC,0x00,0xC0,0x0C,0x00,0xC0,0x0C,0x00,0xC0,0x0C,0x00,0xC0,0x0C,0x00,0xC0,0x0C,0x00,0xFF,0xFF,0xFF,/*"2",2*/
+	0x2B,0x02,0x1C,0xFF,0xFF,0xFF,0xC0,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x33,0xFF,0x3F,0xF0,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0xC0,0x3C,0x03,0xFF,0xFF,0xFF,/*"3",3*/
+	0x2B,0x02,0x1C,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3F,0xFF,0xFF,0xF0,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,/*"4",4*/
+	0x2B,0x02,0x1C,0xFF,0xFF,0xFF,0xC0,0x0C,0x00,0xC0,0x0C,0x00,0xC0,0x0C,0x00,0xC0,0x0C,0x00,0xC0,0x0C,0x00,0xC0,0x0F,0xFF,0xFF,0xF0,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0xC0,0x3C,0x03,0xFF,0xFF,0xFF,/*"5",5*/
+	0x2B,0x02,0x1C,0xFF,0xFF,0xFF,0xC0,0x3C,0x03,0xC0,0x0C,0x00,0xC0,0x0C,0x00,0xC0,0x0C,0x00,0xC0,0x0C,0x00,0xC0,0x0F,0xFF,0xFF,0xFC,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xFF,0xFF,0xFF,/*"6",6*/
+	0x2B,0x02,0x1C,0xFF,0xFF,0xFF,0xC0,0x3C,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,/*"7",7*/
+	0x2B,0x02,0x1C,0xFF,0xFF,0xFF,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3F,0xFF,0xFF,0xFC,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xFF,0xFF,0xFF,/*"8",8*/
+	0x2B,0x02,0x1C,0xFF,0xFF,0xFF,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3C,0x03,0xC0,0x3F,0xFF,0xFF,0xF0,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0x00,0x30,0x03,0xC0,0x3C,0x03,0xFF,0xFF,0xFF,/*"9",9*/
+	0x55,0x04,0x18,0xFF,0xFC,0xF3,0xCF,0x3C,0xF3,0x00,0x00,0x00,0x00,0x00,0x00,0xCF,0x3C,0xF3,0xCF,0x3F,0xFF,/*":",10*/
+	0x00,0x00,/*padding*/
+};
+
+const font_packed_t c_tFont3216 = {16, 32, 0x30, 11, c_hwFont3216Offset, c_chFont3216Packed};
+
+/*-------------------------------END OF FILE-------------------------------*/
@@ -18,6 +18,7 @@
 /* USER CODE END Header */
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
+#include "dma.h"
 #include "spi.h"
 #include "tim.h"
 #include "usart.h"
@@ -30,6 +31,7 @@
 #include "ss_twr_responder.h"
 #include "ssd1331.h"
 #include "buzzer.h"
+#include "scheduler.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -90,6 +92,7 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_SPI1_Init();
   MX_TIM2_Init();
   MX_SPI2_Init();
@@ -99,8 +102,10 @@ int main(void)
   ssd1331_init();
   initBuzzer();
 
+  /* Add the tasks of one of the examples and run them; runScheduler() never returns */
   ss_twr_initiator();
 //  ss_twr_responder();
+  runScheduler();
 
   /* USER CODE END 2 */
 
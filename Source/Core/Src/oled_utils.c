@@ -8,7 +8,7 @@
   ******************************************************************************
   */
 #include "oled_utils.h"
-#include <stdio.h>
+#include "tlog.h"
 #include <string.h>
 
 // Private defines
@@ -48,7 +48,7 @@ void displayTextOnCorner(const char* text, FontSize fontSize, enum Color txtColo
 
   if (SSD1331_WIDTH < lenOnDisplay)
   {
-    printf("[oled_utils::displayTextOnCorner] Error! Text is too long to display\r\n");
+    TLOG("[oled_utils::displayTextOnCorner] Error! Text is too long to display");
     return;
   }
 
@@ -72,11 +72,12 @@ void displayTextOnCorner(const char* text, FontSize fontSize, enum Color txtColo
       break;
 
     default:
-      printf("[oled_utils::displayTextOnCorner] Error! Invalid corner parameter\r\n");
+      TLOG("[oled_utils::displayTextOnCorner] Error! Invalid corner parameter");
       return;
   }
 
   ssd1331_display_string(txtXPos, txtYPos, text, fontSize, txtColour);
+  ssd1331_flush();
 }
 
 // FUNCTION      : displayTextOnANewLine
@@ -107,11 +108,12 @@ void displayTextOnANewLine(const char* text, FontSize fontSize, enum Color txtCo
 
   if (cursor.posY >= SSD1331_HEIGHT)
   {
-    printf("[oled_utils::displayTextOnANewLine] Error! Exceeding maximum number of lines\r\n");
+    TLOG("[oled_utils::displayTextOnANewLine] Error! Exceeding maximum number of lines");
     return;
   }
 
   ssd1331_display_string(txtXPos, cursor.posY, text, fontSize, txtColour);
+  ssd1331_flush();
 
   // Update the cursor position
   cursor.posX = lenOnDisplay;
@@ -171,6 +173,7 @@ void appendDegreeSymbol(FontSize fontSize, enum Color colour)
   const uint8_t circleYPos = cursor.posY + circleRadius;
 
   ssd1331_draw_circle(circleXPos, circleYPos, circleRadius, colour);
+  ssd1331_flush();
 
   // Update the cursor position
   cursor.posX += widthOfCircleIncludingSpace;
@@ -208,6 +211,7 @@ void appendText(const char* text, FontSize fontSize, enum Color txtColour)
   }
 
   ssd1331_display_string(cursor.posX, cursor.posY, text, fontSize, txtColour);
+  ssd1331_flush();
 
   // Update the cursor position
   cursor.posX += lenOnDisplay + 1;
@@ -225,7 +229,8 @@ void appendText(const char* text, FontSize fontSize, enum Color txtColour)
 //    Clears the SSD1331 OLED display relatively quickly by only erasing the lines
 //    that has been written. If all the lines are occupied, this will perform same
 //    as ssd1331_clear_screen() driver function. This function will be faster in all
-//    other scenarios.
+//    other scenarios. Both are a single CLEAR_WINDOW command to the controller, so
+//    no pixel data is sent for the cleared area.
 //    Note: This function is only compatible with displayTextOnANewLine(),
 //    appendDegreeSymbol() and appendText() functions. This function can not
 //    determine the number of lines written if the user use driver functions such as
@@ -234,9 +239,16 @@ void appendText(const char* text, FontSize fontSize, enum Color txtColour)
 // RETURNS       : None
 void quickClearDisplay(void)
 {
-  const uint16_t maxHeightOfWrittenLines = cursor.posY + FONT_LARGE;
+  uint16_t maxHeightOfWrittenLines = cursor.posY + FONT_LARGE;
 
+  if (maxHeightOfWrittenLines > SSD1331_HEIGHT)
+  {
+    maxHeightOfWrittenLines = SSD1331_HEIGHT;
+  }
+
+  // fill_rect() issues CLEAR_WINDOW for black
   ssd1331_fill_rect(0, 0, SSD1331_WIDTH, maxHeightOfWrittenLines, BLACK);
+  ssd1331_flush();
 
   cursor.posX = 0;
   cursor.posY = 0;
@@ -256,4 +268,5 @@ void clearDisplay(void)
   cursor.posY = 0;
 
   ssd1331_clear_screen(BLACK);
+  ssd1331_flush();
 }
@@ -25,6 +25,48 @@ extern  SPI_HandleTypeDef hspi1;    /*clocked from 72MHz*/
  *                              DW1000 SPI section
  *
  *******************************************************************************/
+/*! ------------------------------------------------------------------------------------------------------------------
+ * Register level fast path for short transfers (DECA_SPI_FAST_MAX_LENGTH).
+ *
+ * Most accesses on the ranging path are a 1 or 2 byte header followed by 1 to 5 bytes of data. For those the cost
+ * is dominated by HAL bookkeeping rather than the wire time (one byte is 16 core clocks at the fast rate), so they
+ * are done here directly on SPI1: chip select is driven through BSRR, there is no HAL_SPI_GetState() spin (all
+ * transfers to the DW3000 are polled and serialised by decamutexon()), and each byte is written to DR and read
+ * back in lock step, which also keeps the receiver free of overruns.
+ *
+ * HAL_SPI_Init() (e.g. from port_set_dw_ic_spi_fastrate()) leaves the peripheral disabled, so SPE is set here
+ * if needed, the same way HAL_SPI_Transmit() does it.
+ */
+static inline void spi_fast_cs_low(void)
+{
+    DW_NSS_GPIO_Port->BSRR = (uint32_t)DW_NSS_Pin << 16U;
+}
+
+static inline void spi_fast_cs_high(SPI_TypeDef *spi)
+{
+    while((spi->SR & SPI_SR_BSY) != 0);
+    DW_NSS_GPIO_Port->BSRR = DW_NSS_Pin;
+}
+
+static inline SPI_TypeDef *spi_fast_enable(void)
+{
+    SPI_TypeDef *spi = hspi1.Instance;
+
+    if((spi->CR1 & SPI_CR1_SPE) == 0)
+    {
+        spi->CR1 |= SPI_CR1_SPE;
+    }
+    return spi;
+}
+
+static inline uint8_t spi_fast_xfer_byte(SPI_TypeDef *spi, uint8_t out)
+{
+    while((spi->SR & SPI_SR_TXE) == 0);
+    *(__IO uint8_t *)&spi->DR = out;
+    while((spi->SR & SPI_SR_RXNE) == 0);
+    return *(__IO uint8_t *)&spi->DR;
+}
+
 /*! ------------------------------------------------------------------------------------------------------------------
  * Function: openspi()
  *
@@ -80,6 +122,82 @@ int writetospiwithcrc(
 } // end writetospiwithcrc()
 
 
+/*! ------------------------------------------------------------------------------------------------------------------
+ * Function: writetospiwithhwcrc()
+ *
+ * Low level abstract function to write to the SPI when SPI CRC mode is used, with the CRC8 byte generated by the
+ * STM32 SPI CRC unit instead of software. The DW3000 SPI CRC is CRC-8 with polynomial x^8+x^2+x+1 (0x07) and
+ * zero seed, no reflection and no final XOR, which is exactly what the SPIx_TXCRCR register computes when CRCPR is
+ * set to 0x07 and the frame format is 8-bit. The CRC accumulates over the header and body as they are shifted out
+ * and is appended by setting CRCNEXT right after the last body byte has been loaded into DR.
+ *
+ * CRCEN may only be changed with SPE cleared, so the peripheral is briefly disabled before and after the transfer.
+ * The receiver also checks the (don't care) MISO bytes against its own CRC, so CRCERR is cleared on exit.
+ * returns 0 for success, or -1 for error
+ */
+int writetospiwithhwcrc(
+                uint16_t      headerLength,
+                const uint8_t *headerBuffer,
+                uint16_t      bodyLength,
+                const uint8_t *bodyBuffer)
+{
+    SPI_TypeDef *spi = hspi1.Instance;
+    uint32_t    cr1;
+    uint16_t    i;
+    decaIrqStatus_t  stat ;
+    stat = decamutexon() ;
+    while (HAL_SPI_GetState(&hspi1) != HAL_SPI_STATE_READY);
+
+    /* Reset and enable the CRC unit: CRCEN write clears TXCRCR/RXCRCR */
+    cr1 = spi->CR1;
+    spi->CR1 = cr1 & ~(SPI_CR1_SPE | SPI_CR1_CRCEN);
+    spi->CRCPR = 0x07;
+    spi->CR1 = (cr1 & ~SPI_CR1_CRCNEXT) | SPI_CR1_CRCEN | SPI_CR1_SPE;
+
+    HAL_GPIO_WritePin(DW_NSS_GPIO_Port, DW_NSS_Pin, GPIO_PIN_RESET); /**< Put chip select line low */
+
+    /* Header, and body, clocked out a byte at a time; the last byte written is followed by CRCNEXT */
+    for(i=0; i<headerLength; i++)
+    {
+        while((spi->SR & SPI_SR_TXE) == 0);
+        *(__IO uint8_t *)&spi->DR = headerBuffer[i];
+        if((bodyLength == 0) && (i == headerLength - 1))
+        {
+            spi->CR1 |= SPI_CR1_CRCNEXT;
+        }
+        while((spi->SR & SPI_SR_RXNE) == 0);
+        (void)spi->DR;
+    }
+
+    for(i=0; i<bodyLength; i++)
+    {
+        while((spi->SR & SPI_SR_TXE) == 0);
+        *(__IO uint8_t *)&spi->DR = bodyBuffer[i];
+        if(i == bodyLength - 1)
+        {
+            spi->CR1 |= SPI_CR1_CRCNEXT;
+        }
+        while((spi->SR & SPI_SR_RXNE) == 0);
+        (void)spi->DR;
+    }
+
+    /* CRC byte phase: the peripheral sends TXCRCR, and the byte received alongside it is discarded */
+    while((spi->SR & SPI_SR_RXNE) == 0);
+    (void)spi->DR;
+    while((spi->SR & SPI_SR_BSY) != 0);
+
+    HAL_GPIO_WritePin(DW_NSS_GPIO_Port, DW_NSS_Pin, GPIO_PIN_SET); /**< Put chip select line high */
+
+    /* Restore the plain 8-bit configuration used by the other transfer functions */
+    spi->SR = (uint16_t)~SPI_SR_CRCERR;
+    spi->CR1 = cr1 & ~(SPI_CR1_SPE | SPI_CR1_CRCEN | SPI_CR1_CRCNEXT);
+    spi->CR1 = cr1;
+
+    decamutexoff(stat);
+    return 0;
+} // end writetospiwithhwcrc()
+
+
 /*! ------------------------------------------------------------------------------------------------------------------
  * Function: writetospi()
  *
@@ -95,6 +213,26 @@ int writetospi(uint16_t       headerLength,
     decaIrqStatus_t  stat ;
     stat = decamutexon() ;
 
+    if((uint32_t)headerLength + bodyLength <= DECA_SPI_FAST_MAX_LENGTH)
+    {
+        SPI_TypeDef *spi = spi_fast_enable();
+        uint16_t    i;
+
+        spi_fast_cs_low();
+        for(i=0; i<headerLength; i++)
+        {
+            (void)spi_fast_xfer_byte(spi, headerBuffer[i]);
+        }
+        for(i=0; i<bodyLength; i++)
+        {
+            (void)spi_fast_xfer_byte(spi, bodyBuffer[i]);
+        }
+        spi_fast_cs_high(spi);
+
+        decamutexoff(stat);
+        return 0;
+    }
+
     while (HAL_SPI_GetState(&hspi1) != HAL_SPI_STATE_READY);
 
     HAL_GPIO_WritePin(DW_NSS_GPIO_Port, DW_NSS_Pin, GPIO_PIN_RESET); /**< Put chip select line low */
@@ -155,6 +293,25 @@ int readfromspi(uint16_t  headerLength,
     decaIrqStatus_t  stat ;
     stat = decamutexon() ;
 
+    if((uint32_t)headerLength + readlength <= DECA_SPI_FAST_MAX_LENGTH)
+    {
+        SPI_TypeDef *spi = spi_fast_enable();
+
+        spi_fast_cs_low();
+        for(i=0; i<headerLength; i++)
+        {
+            (void)spi_fast_xfer_byte(spi, headerBuffer[i]);
+        }
+        while(readlength-- > 0)
+        {
+            (*readBuffer++) = spi_fast_xfer_byte(spi, 0); /* MOSI held at 0, see below */
+        }
+        spi_fast_cs_high(spi);
+
+        decamutexoff(stat);
+        return 0;
+    }
+
     /* Blocking: Check whether previous transfer has been finished */
     while (HAL_SPI_GetState(&hspi1) != HAL_SPI_STATE_READY);
 
@@ -21,6 +21,7 @@ extern "C" {
 #include <deca_types.h>
 
 #define DECA_MAX_SPI_HEADER_LENGTH      (3)                     // max number of bytes in header (for formating & sizing)
+#define DECA_SPI_FAST_MAX_LENGTH        (8)                     // transfers up to this many bytes (header + data) bypass the HAL, 0 disables
 /*! ------------------------------------------------------------------------------------------------------------------
  * Function: openspi()
  *
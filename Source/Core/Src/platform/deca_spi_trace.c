@@ -0,0 +1,295 @@
+/*! ----------------------------------------------------------------------------
+ * @file    deca_spi_trace.c
+ * @brief   SPI transaction tracer and bus utilisation profiler for the DW3000 driver
+ *
+ *          dwt_xfer3000() calls spitrace_begin() before and spitrace_end() after each transaction when
+ *          DWT_SPI_TRACE is defined. Durations are measured with DWT->CYCCNT and include the platform
+ *          transfer functions (chip select, header, data and, in CRC mode, the CRC byte), but not the
+ *          software CRC or the WRRD read-back which is traced as a transaction of its own.
+ */
+
+#include <deca_spi_trace.h>
+
+#ifdef DWT_SPI_TRACE
+
+#include <stdio.h>
+#include <string.h>
+#include "main.h"
+
+/* Statistics of one register (register file + offset) */
+typedef struct
+{
+    uint32_t addr;                          /* regFileID + indx */
+    uint32_t count;                         /* transactions in this window */
+    uint32_t bytes;                         /* data bytes in this window */
+    uint32_t cycles;                        /* total cycles in this window */
+    uint32_t maxCycles;                     /* longest transaction in this window */
+    uint8_t  access;                        /* spitrace_access_e of the last transaction */
+    uint16_t hist[SPITRACE_HIST_BINS];      /* log2 duration histogram */
+} spitrace_reg_t;
+
+static spitrace_record_t ring[SPITRACE_RING_SIZE];
+static uint32_t          ringHead;          /* total records written, index is ringHead % SPITRACE_RING_SIZE */
+
+static spitrace_reg_t    regs[SPITRACE_MAX_REGS + 1];   /* last entry collects registers that did not fit */
+static uint16_t          numRegs;
+static uint32_t          windowStart;       /* DWT->CYCCNT at the start of the reporting window */
+static uint32_t          lastReportTick;
+
+/* Histogram bin of a duration: bin 0 is < 2^SPITRACE_HIST_MIN_LOG2 cycles, each next bin doubles */
+static uint8_t spitrace_bin(uint32_t cycles)
+{
+    uint8_t bin = 0;
+
+    cycles >>= SPITRACE_HIST_MIN_LOG2;
+    while ((cycles != 0) && (bin < SPITRACE_HIST_BINS - 1))
+    {
+        cycles >>= 1;
+        bin++;
+    }
+    return bin;
+}
+
+static spitrace_reg_t *spitrace_find(uint32_t addr)
+{
+    uint16_t i;
+
+    for (i = 0; i < numRegs; i++)
+    {
+        if (regs[i].addr == addr)
+        {
+            return &regs[i];
+        }
+    }
+    if (numRegs < SPITRACE_MAX_REGS)
+    {
+        regs[numRegs].addr = addr;
+        return &regs[numRegs++];
+    }
+    return &regs[SPITRACE_MAX_REGS];
+}
+
+/*! ------------------------------------------------------------------------------------------------------------------
+ * @fn spitrace_init()
+ *
+ * @brief Enables the DWT cycle counter and clears the ring buffer and statistics.
+ */
+void spitrace_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    memset(ring, 0, sizeof(ring));
+    memset(regs, 0, sizeof(regs));
+    regs[SPITRACE_MAX_REGS].addr = 0xFFFFFFFFUL;
+    ringHead = 0;
+    numRegs = 0;
+    windowStart = DWT->CYCCNT;
+    lastReportTick = HAL_GetTick();
+}
+
+/*! ------------------------------------------------------------------------------------------------------------------
+ * @fn spitrace_begin()
+ *
+ * @brief Trace hook called by dwt_xfer3000() before a transaction.
+ *
+ * @return current cycle count, passed back to spitrace_end()
+ */
+uint32_t spitrace_begin(void)
+{
+    return DWT->CYCCNT;
+}
+
+/*! ------------------------------------------------------------------------------------------------------------------
+ * @fn spitrace_end()
+ *
+ * @brief Trace hook called by dwt_xfer3000() after a transaction. Records it in the ring buffer and the statistics.
+ *        May be called from the DW3000 interrupt, so the update is done with interrupts masked.
+ *
+ * @param start         - value returned by spitrace_begin()
+ * @param regFileID     - register file ID as passed to dwt_xfer3000()
+ * @param indx          - byte index into the register file
+ * @param length        - number of data bytes
+ * @param mode          - DW3000_SPI_RD_BIT, DW3000_SPI_WR_BIT or DW3000_SPI_AND_OR_x
+ * @param headerLength  - SPI header length, 1 or 2
+ */
+void spitrace_end(uint32_t start, uint32_t regFileID, uint16_t indx, uint16_t length, uint16_t mode, uint16_t headerLength)
+{
+    uint32_t cycles = DWT->CYCCNT - start;
+    uint32_t addr = regFileID + indx;
+    uint32_t primask;
+    spitrace_record_t *rec;
+    spitrace_reg_t *reg;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    rec = &ring[ringHead++ % SPITRACE_RING_SIZE];
+    rec->start  = start;
+    rec->cycles = cycles;
+    rec->length = length;
+    rec->mode   = mode;
+    rec->file   = (uint8_t)(0x1F & (addr >> 16));
+    rec->offset = (uint8_t)(0x7F & addr);
+    rec->access = (headerLength == 2) ? SPITRACE_EAMRW : ((length == 0) ? SPITRACE_FAC : SPITRACE_FARW);
+
+    reg = spitrace_find(addr);
+    reg->count++;
+    reg->bytes += length;
+    reg->cycles += cycles;
+    if (cycles > reg->maxCycles)
+    {
+        reg->maxCycles = cycles;
+    }
+    reg->hist[spitrace_bin(cycles)]++;
+    reg->access = rec->access;
+
+    __set_PRIMASK(primask);
+}
+
+/*! ------------------------------------------------------------------------------------------------------------------
+ * @fn spitrace_report()
+ *
+ * @brief Prints bus utilisation since the last report and the per-register statistics, then starts a new window.
+ */
+void spitrace_report(void)
+{
+    static const char *accessName[] = { "FAC", "FARW", "EAM" };
+    spitrace_reg_t snap[SPITRACE_MAX_REGS + 1];
+    uint16_t n, i, b;
+    uint32_t elapsed, busy = 0, primask;
+
+    /* Take a snapshot so printing (which is slow) does not race with the hooks */
+    primask = __get_PRIMASK();
+    __disable_irq();
+    n = numRegs;
+    memcpy(snap, regs, sizeof(snap));
+    elapsed = DWT->CYCCNT - windowStart;
+    __set_PRIMASK(primask);
+
+    for (i = 0; i <= SPITRACE_MAX_REGS; i++)
+    {
+        busy += snap[i].cycles;
+    }
+
+    printf("SPI trace: %lu cycles, busy %lu (%lu.%lu%%)\r\n", (unsigned long)elapsed, (unsigned long)busy,
+           (unsigned long)(elapsed ? (uint64_t)busy * 100 / elapsed : 0),
+           (unsigned long)(elapsed ? ((uint64_t)busy * 1000 / elapsed) % 10 : 0));
+    printf("  reg       count  bytes   avg   max  hist <128 <256 <512 <1k <2k <4k <8k >=8k\r\n");
+    for (i = 0; i <= SPITRACE_MAX_REGS; i++)
+    {
+        if ((i >= n && i != SPITRACE_MAX_REGS) || snap[i].count == 0)
+        {
+            continue;
+        }
+        if (i == SPITRACE_MAX_REGS)
+        {
+            printf("  other   ");
+        }
+        else
+        {
+            printf("  %02lX:%02lX %-4s", (unsigned long)(0x1F & (snap[i].addr >> 16)), (unsigned long)(0x7F & snap[i].addr),
+                   accessName[snap[i].access]);
+        }
+        printf(" %6lu %6lu %5lu %5lu     ", (unsigned long)snap[i].count, (unsigned long)snap[i].bytes,
+               (unsigned long)(snap[i].cycles / snap[i].count), (unsigned long)snap[i].maxCycles);
+        for (b = 0; b < SPITRACE_HIST_BINS; b++)
+        {
+            printf(" %4u", snap[i].hist[b]);
+        }
+        printf("\r\n");
+    }
+
+    /* New window */
+    primask = __get_PRIMASK();
+    __disable_irq();
+    memset(regs, 0, sizeof(regs));
+    regs[SPITRACE_MAX_REGS].addr = 0xFFFFFFFFUL;
+    numRegs = 0;
+    windowStart = DWT->CYCCNT;
+    __set_PRIMASK(primask);
+}
+
+/*! ------------------------------------------------------------------------------------------------------------------
+ * @fn spitrace_poll()
+ *
+ * @brief Prints the summary once every SPITRACE_REPORT_MS.
+ */
+void spitrace_poll(void)
+{
+    if ((HAL_GetTick() - lastReportTick) >= SPITRACE_REPORT_MS)
+    {
+        lastReportTick = HAL_GetTick();
+        spitrace_report();
+    }
+}
+
+/*! ------------------------------------------------------------------------------------------------------------------
+ * @fn spitrace_get()
+ *
+ * @brief Copies the last 'count' transactions from the ring buffer, oldest first.
+ */
+uint16_t spitrace_get(spitrace_record_t *buf, uint16_t count)
+{
+    uint32_t head, first, i, primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    head = ringHead;
+    if (count > SPITRACE_RING_SIZE)
+    {
+        count = SPITRACE_RING_SIZE;
+    }
+    if (count > head)
+    {
+        count = (uint16_t)head;
+    }
+    first = head - count;
+    for (i = 0; i < count; i++)
+    {
+        buf[i] = ring[(first + i) % SPITRACE_RING_SIZE];
+    }
+    __set_PRIMASK(primask);
+
+    return count;
+}
+
+/*! ------------------------------------------------------------------------------------------------------------------
+ * @fn spitrace_dump()
+ *
+ * @brief Prints the last 'count' transactions from the ring buffer, oldest first.
+ */
+void spitrace_dump(uint16_t count)
+{
+    static const char *accessName[] = { "FAC", "FARW", "EAM" };
+    spitrace_record_t rec;
+    uint16_t i;
+
+    if (count > SPITRACE_RING_SIZE)
+    {
+        count = SPITRACE_RING_SIZE;
+    }
+    for (i = 0; i < count; i++)
+    {
+        /* Records are fetched one at a time to keep the stack small */
+        uint32_t idx, primask;
+
+        primask = __get_PRIMASK();
+        __disable_irq();
+        if (ringHead < (uint32_t)count - i)
+        {
+            __set_PRIMASK(primask);
+            continue;
+        }
+        idx = ringHead - (count - i);
+        rec = ring[idx % SPITRACE_RING_SIZE];
+        __set_PRIMASK(primask);
+
+        printf("%10lu %02X:%02X %-4s %s len %u %lu cyc\r\n", (unsigned long)rec.start, rec.file, rec.offset,
+               accessName[rec.access], (rec.mode == DW3000_SPI_RD_BIT) ? "RD" : ((rec.mode == DW3000_SPI_WR_BIT) ? "WR" : "AO"),
+               rec.length, (unsigned long)rec.cycles);
+    }
+}
+
+#endif /* DWT_SPI_TRACE */
@@ -0,0 +1,116 @@
+/*! ----------------------------------------------------------------------------
+ * @file    deca_spi_trace.h
+ * @brief   SPI transaction tracer and bus utilisation profiler for the DW3000 driver
+ *
+ *          Enabled with DWT_SPI_TRACE (deca_device_api.h). Every transaction made through dwt_xfer3000() is
+ *          timed with the Cortex-M4 cycle counter (DWT->CYCCNT) and recorded in a RAM ring buffer, and
+ *          per-register statistics with a log2 duration histogram are accumulated for a periodic summary.
+ *
+ *          When DWT_SPI_TRACE is not defined the functions below compile to empty inlines.
+ */
+
+#ifndef _DECA_SPI_TRACE_H_
+#define _DECA_SPI_TRACE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <deca_device_api.h>
+
+#define SPITRACE_RING_SIZE      (128)   /* number of transactions kept in the ring buffer (power of 2) */
+#define SPITRACE_MAX_REGS       (24)    /* number of distinct registers with their own statistics */
+#define SPITRACE_HIST_BINS      (8)     /* histogram bins: <128, <256, <512, ... , >=8192 cycles */
+#define SPITRACE_HIST_MIN_LOG2  (7)     /* log2 of the upper edge of the first histogram bin */
+#define SPITRACE_REPORT_MS      (10000) /* summary period of spitrace_poll() */
+
+/* Access mode of a transaction as chosen by dwt_xfer3000() */
+typedef enum
+{
+    SPITRACE_FAC = 0,       /* fast command, 1 byte header and no data */
+    SPITRACE_FARW,          /* short address read/write, 1 byte header */
+    SPITRACE_EAMRW          /* full address read/write or masked write, 2 byte header */
+} spitrace_access_e;
+
+/* One ring buffer record */
+typedef struct
+{
+    uint32_t start;         /* DWT->CYCCNT at the start of the transaction */
+    uint32_t cycles;        /* duration of the transaction in CPU cycles */
+    uint16_t length;        /* number of data bytes */
+    uint16_t mode;          /* DW3000_SPI_RD_BIT, DW3000_SPI_WR_BIT or DW3000_SPI_AND_OR_x */
+    uint8_t  file;          /* register file (base address >> 16) */
+    uint8_t  offset;        /* byte offset into the register file */
+    uint8_t  access;        /* spitrace_access_e */
+    uint8_t  reserved;
+} spitrace_record_t;
+
+#ifdef DWT_SPI_TRACE
+
+/*! ------------------------------------------------------------------------------------------------------------------
+ * @fn spitrace_init()
+ *
+ * @brief Enables the DWT cycle counter and clears the ring buffer and statistics.
+ *
+ * @return none
+ */
+void spitrace_init(void);
+
+/*! ------------------------------------------------------------------------------------------------------------------
+ * @fn spitrace_poll()
+ *
+ * @brief Prints the summary with spitrace_report() once every SPITRACE_REPORT_MS. Call from a periodic task.
+ *
+ * @return none
+ */
+void spitrace_poll(void);
+
+/*! ------------------------------------------------------------------------------------------------------------------
+ * @fn spitrace_report()
+ *
+ * @brief Prints bus utilisation since the last report, followed by count, bytes, average/maximum duration and
+ *        histogram for each register, then starts a new reporting window.
+ *
+ * @return none
+ */
+void spitrace_report(void);
+
+/*! ------------------------------------------------------------------------------------------------------------------
+ * @fn spitrace_dump()
+ *
+ * @brief Prints the last 'count' transactions from the ring buffer, oldest first.
+ *
+ * @param count - number of records to print, limited to SPITRACE_RING_SIZE
+ *
+ * @return none
+ */
+void spitrace_dump(uint16_t count);
+
+/*! ------------------------------------------------------------------------------------------------------------------
+ * @fn spitrace_get()
+ *
+ * @brief Copies the last 'count' transactions from the ring buffer, oldest first.
+ *
+ * @param buf   - destination for the records
+ * @param count - size of buf in records
+ *
+ * @return number of records copied
+ */
+uint16_t spitrace_get(spitrace_record_t *buf, uint16_t count);
+
+#else
+
+static inline void spitrace_init(void) {}
+static inline void spitrace_poll(void) {}
+static inline void spitrace_report(void) {}
+static inline void spitrace_dump(uint16_t count) { (void)count; }
+static inline uint16_t spitrace_get(spitrace_record_t *buf, uint16_t count) { (void)buf; (void)count; return 0; }
+
+#endif /* DWT_SPI_TRACE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DECA_SPI_TRACE_H_ */
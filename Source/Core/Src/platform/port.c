@@ -13,8 +13,8 @@
 
 #include <port.h>
 //#include <stm32f1xx_hal_conf.h>
-//#include <usbd_cdc_if.h>
 #include "main.h"
+#include "flash_log.h"
 
 /****************************************************************************//**
  *
@@ -510,126 +510,333 @@ __INLINE uint32_t port_CheckEXT_IRQ(void)
 
 /****************************************************************************//**
  *
- *                              USB report section
+ *                              Report section
  *
  *******************************************************************************/
-//#include <usb_device.h>
+#if (REPORT_USB_CDC == 1)
+#ifndef HAL_PCD_MODULE_ENABLED
+#error "REPORT_USB_CDC needs the USB device CDC middleware and USB_OTG_FS on PA11/PA12, PA11 is the buzzer (TIM1_CH4)"
+#endif
+#include "usbd_cdc_if.h"
+#else
+#include "usart.h"
+#endif
+
+#define REPORT_BUFSIZE  0x2000      /**< power of 2 */
+
+/* The report buffer is a lock-free single producer, single consumer ring:
+ *  - head is only written by port_tx_msg(), while it holds the writer token;
+ *  - tail is only written by port_tx_cplt();
+ *  - the bytes from tail to head are sent on the report link in contiguous chunks,
+ *    each next chunk is started from the TX complete interrupt, see report_tx_send().
+ * Nothing ever waits: a message which does not fit, or which is written from an
+ * interrupt while another writer holds the token, is dropped as a whole and counted.
+ * This relies on the interrupts of the link (USART2 and DMA1 Stream6, or OTG_FS)
+ * not preempting the writers of the buffer, which holds while all interrupts
+ * share one priority (see MX_DMA_Init()).
+ *
+ * Large blocks, e.g. CIR dumps, are not copied to the ring: port_tx_block() queues
+ * a pointer and the DMA sends the block from where it is. Blocks are sent between
+ * two ring chunks, never inside one, and alternate with the ring chunks, so a
+ * stream of blocks cannot hold back the short messages.
+ * */
+static char     rbuf[REPORT_BUFSIZE];               /**< circular report buffer, data to be transmitted on the report link */
+static volatile struct circ_buf report_buf = { .buf = rbuf,
+                                               .head= 0,
+                                               .tail= 0};
 
-#define REPORT_BUFSIZE  0x2000
+static volatile uint8_t  tx_writer  = 0;    /**< writer token, held by port_tx_msg() */
+static volatile uint8_t  tx_busy    = 0;    /**< a DMA chunk is being sent */
+static volatile int      tx_chunk   = 0;    /**< length of that chunk */
+static volatile uint32_t tx_dropped = 0;    /**< messages dropped, see port_tx_dropped() */
 
-//extern USBD_HandleTypeDef  hUsbDeviceFS;
+#define REPORT_BLOCKS   2           /**< power of 2, blocks queued by port_tx_block() */
 
 static struct
 {
-    HAL_LockTypeDef       Lock;     /*!< locking object                  */
+    const uint8_t   *buf;
+    int             len;
+    port_tx_done_t  done;
+} tx_blocks[REPORT_BLOCKS];
+static volatile uint8_t  block_head = 0;    /**< next block to send, only moved by the TX complete interrupt */
+static volatile uint8_t  block_tail = 0;    /**< next free entry, only moved by port_tx_block() */
+static volatile uint8_t  tx_is_block = 0;   /**< the transfer in flight is a block, not a ring chunk */
+
+/* @fn      report_take_writer()
+ * @brief   take the writer token without waiting
+ * @return  1 - taken, 0 - held by a writer which has been interrupted
+ * */
+static int report_take_writer(void)
+{
+    do
+    {
+        if(__LDREXB(&tx_writer) != 0)
+        {
+            __CLREX();
+            return 0;
+        }
+    } while(__STREXB(1, &tx_writer) != 0);
+
+    __DMB();
+    return 1;
+}
+
+static void report_release_writer(void)
+{
+    __DMB();
+    tx_writer = 0;
 }
-txhandle={.Lock = HAL_UNLOCKED};
 
-static char     rbuf[REPORT_BUFSIZE];               /**< circular report buffer, data to be transmitted in flush_report_buff() Thread */
-static struct   circ_buf report_buf = { .buf = rbuf,
-                                        .head= 0,
-                                        .tail= 0};
+static void report_count_drop(void)
+{
+    uint32_t n;
+
+    do
+    {
+        n = __LDREXW(&tx_dropped) + 1;
+    } while(__STREXW(n, &tx_dropped) != 0);
+}
+
+/* @fn      report_tx_send()
+ * @brief   start sending a chunk or a block on the report link in background:
+ *          USART2 TX DMA, or USB CDC with REPORT_USB_CDC
+ * @return  1 - started, port_tx_cplt() follows once it has been sent
+ *          0 - link not ready, e.g. USART2 not initialised or no USB host
+ * */
+static int report_tx_send(const uint8_t *buf, int len)
+{
+#if (REPORT_USB_CDC == 1)
+    return CDC_Transmit_FS((uint8_t*)buf, (uint16_t)len) == USBD_OK;
+#else
+    return HAL_UART_Transmit_DMA(&huart2, (uint8_t*)buf, (uint16_t)len) == HAL_OK;
+#endif
+}
+
+/* @fn      report_tx_start()
+ * @brief   start sending the bytes from tail up to head, or to the end of the buffer
+ *          called with the transmitter idle: by a writer holding the token,
+ *          or from the TX complete interrupt
+ * */
+static void report_tx_start(void)
+{
+    int head = report_buf.head;
+    int tail = report_buf.tail;
+    int len  = CIRC_CNT_TO_END(head, tail, REPORT_BUFSIZE);
+
+    /* a block goes first, unless the previous transfer was a block and the ring has data */
+    if(block_tail != block_head && (len == 0 || !tx_is_block))
+    {
+        tx_busy     = 1;
+        tx_is_block = 1;
+        if(!report_tx_send(tx_blocks[block_head % REPORT_BLOCKS].buf, tx_blocks[block_head % REPORT_BLOCKS].len))
+        {
+            tx_busy = 0;
+        }
+        return;
+    }
+
+    tx_is_block = 0;
+    if(len == 0)
+    {
+        tx_busy = 0;
+        return;
+    }
 
-//static uint8_t  ubuf[CDC_DATA_FS_MAX_PACKET_SIZE];  /**< used to transmit new chunk of data in single USB flush */
+    tx_busy  = 1;
+    tx_chunk = len;
+    if(!report_tx_send((uint8_t*)&rbuf[tail], len))
+    {
+        /* link not ready yet: the data stays queued until the next message */
+        tx_busy = 0;
+    }
+}
 
 /* @fn      port_tx_msg()
  * @brief   put message to circular report buffer
- *          it will be transmitted in background ASAP from flushing Thread
- * @return  HAL_BUSY - can not do it now, wait for release
- *          HAL_ERROR- buffer overflow
+ *          it will be transmitted in background ASAP on the report link
+ *          never blocks, can be called from interrupts
+ * @return  HAL_BUSY - another writer was interrupted, message dropped
+ *          HAL_ERROR- buffer overflow, message dropped
  *          HAL_OK   - scheduled for transmission
  * */
 HAL_StatusTypeDef port_tx_msg(uint8_t   *str, int  len)
 {
-    int head, tail, size;
-    HAL_StatusTypeDef   ret;
+    int head, tail, n, size = REPORT_BUFSIZE;
 
-    /* add TX msg to circular buffer and increase circular buffer length */
+    if(!report_take_writer())
+    {
+        report_count_drop();
+        return HAL_BUSY;
+    }
 
-    __HAL_LOCK(&txhandle);  //return HAL_BUSY if locked
     head = report_buf.head;
     tail = report_buf.tail;
-    __HAL_UNLOCK(&txhandle);
 
-    size = REPORT_BUFSIZE;
+    if(CIRC_SPACE(head, tail, size) < len)
+    {
+        /* if packet can not fit, drop it as a whole, a partial line is worse than none */
+        report_release_writer();
+        report_count_drop();
+        return HAL_ERROR;
+    }
 
-    if(CIRC_SPACE(head, tail, size) > (len))
+    /* copy in at most two pieces, the second one wraps to the start of the buffer */
+    n = CIRC_SPACE_TO_END(head, tail, size);
+    if(n > len)
     {
-        while (len > 0)
-        {
-            report_buf.buf[head]= *(str++);
-            head= (head+1) & (size - 1);
-            len--;
-        }
+        n = len;
+    }
+    memcpy(&rbuf[head], str, n);
+    memcpy(&rbuf[0], str + n, len - n);
 
-        __HAL_LOCK(&txhandle);  //return HAL_BUSY if locked
-        report_buf.head = head;
-        __HAL_UNLOCK(&txhandle);
+    __DMB();    /* the data must be in place before the DMA can see the new head */
+    report_buf.head = (head + len) & (size - 1);
 
-#ifdef CMSIS_RTOS
-        osSignalSet(usbTxTaskHandle, signalUsbFlush);   //RTOS multitasking signal start flushing
-#endif
-        ret = HAL_OK;
+    if(!tx_busy)
+    {
+        report_tx_start();
     }
-    else
+
+    report_release_writer();
+    return HAL_OK;
+}
+
+/* @fn      port_tx_block()
+ * @brief   queue a block to be transmitted on the report link straight from its buffer
+ *          the buffer must stay unchanged until done() is called from the
+ *          TX complete interrupt; never blocks, can be called from interrupts
+ * @param   buf  - data, at most 65535 bytes
+ * @param   len  - length of the data
+ * @param   done - called with buf once the block has been sent, may be NULL
+ * @return  HAL_BUSY - queue full or another writer was interrupted, block not queued
+ *          HAL_OK   - scheduled for transmission
+ * */
+HAL_StatusTypeDef port_tx_block(const uint8_t *buf, int len, port_tx_done_t done)
+{
+    if(!report_take_writer())
+    {
+        return HAL_BUSY;
+    }
+
+    if((uint8_t)(block_tail - block_head) >= REPORT_BLOCKS)
+    {
+        report_release_writer();
+        return HAL_BUSY;
+    }
+
+    tx_blocks[block_tail % REPORT_BLOCKS].buf  = buf;
+    tx_blocks[block_tail % REPORT_BLOCKS].len  = len;
+    tx_blocks[block_tail % REPORT_BLOCKS].done = done;
+
+    __DMB();    /* the entry must be in place before the interrupt can see the new tail */
+    block_tail++;
+
+    if(!tx_busy)
     {
-        /* if packet can not fit, setup TX Buffer overflow ERROR and exit */
-        ret = HAL_ERROR;
+        report_tx_start();
     }
 
-    return ret;
+    report_release_writer();
+    return HAL_OK;
 }
 
+/* @fn      port_tx_dropped()
+ * @return  number of messages dropped by port_tx_msg() since reset
+ * */
+uint32_t port_tx_dropped(void)
+{
+    return tx_dropped;
+}
 
 /* @fn      flush_report_buff
- * @brief   FLUSH should have higher priority than port_tx_msg()
- *          it shall be called periodically from process, which can not be locked,
- *          i.e. from independent high priority thread
+ * @brief   restart sending of the report buffer if it is idle,
+ *          e.g. for data written before the link was ready
+ * @return  HAL_BUSY - a writer holds the buffer, try again later
+ *          HAL_OK   - sending or nothing to send
  * */
-//HAL_StatusTypeDef flush_report_buff(void)
-//{
-//    USBD_CDC_HandleTypeDef   *hcdc = (USBD_CDC_HandleTypeDef*)(hUsbDeviceFS.pClassData);
-//
-//    int i, head, tail, len, size = REPORT_BUFSIZE;
-//
-//    __HAL_LOCK(&txhandle);  //"return HAL_BUSY;" if locked
-//    head = report_buf.head;
-//    tail = report_buf.tail;
-//    __HAL_UNLOCK(&txhandle);
-//
-//    len = CIRC_CNT(head, tail, size);
-//
-//    if( len > 0 )
-//    {
-//        /*  check USB status - ready to TX */
-//        if((hUsbDeviceFS.dev_state != USBD_STATE_CONFIGURED) || (hcdc->TxState != 0))
-//        {
-//            return HAL_BUSY;    /**< USB is busy. Let it send now, will return next time */
-//        }
-//
-//
-//        /* copy MAX allowed length from circular buffer to non-circular TX buffer */
-//        len = MIN(CDC_DATA_FS_MAX_PACKET_SIZE, len);
-//
-//        for(i=0; i<len; i++)
-//        {
-//            ubuf[i] = report_buf.buf[tail];
-//            tail = (tail + 1) & (size - 1);
-//        }
-//
-//        __HAL_LOCK(&txhandle);  //"return HAL_BUSY;" if locked
-//        report_buf.tail = tail;
-//        __HAL_UNLOCK(&txhandle);
-//
-//        /* setup USB IT transfer */
-//        if(CDC_Transmit_FS(ubuf, (uint16_t)len) != USBD_OK)
-//        {
-//            /**< indicate USB transmit error */
-//        }
-//    }
-//
-//    return HAL_OK;
-//}
+HAL_StatusTypeDef flush_report_buff(void)
+{
+    if(!report_take_writer())
+    {
+        return HAL_BUSY;
+    }
+
+    if(!tx_busy)
+    {
+        report_tx_start();
+    }
+
+    report_release_writer();
+    return HAL_OK;
+}
+
+/* @fn      port_tx_cplt()
+ * @brief   a chunk or a block has been sent: release it and send the next one
+ *          called from the TX complete interrupt of the report link, with
+ *          REPORT_USB_CDC from CDC_TransmitCplt_FS() in usbd_cdc_if.c
+ * */
+void port_tx_cplt(void)
+{
+    const uint8_t   *buf;
+    port_tx_done_t  done;
+
+    if(!tx_busy)
+    {
+        return;
+    }
+
+    if(tx_is_block)
+    {
+        buf  = tx_blocks[block_head % REPORT_BLOCKS].buf;
+        done = tx_blocks[block_head % REPORT_BLOCKS].done;
+        block_head++;
+        if(done)
+        {
+            done(buf);
+        }
+    }
+    else
+    {
+        report_buf.tail = (report_buf.tail + tx_chunk) & (REPORT_BUFSIZE - 1);
+    }
+
+    report_tx_start();
+}
+
+#if (REPORT_USB_CDC == 0)
+/* @fn      HAL_UART_TxCpltCallback
+ * @brief   USART2 TX DMA has sent a chunk or a block
+ * */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if(huart->Instance == USART2)
+    {
+        port_tx_cplt();
+    }
+}
+#endif
+
+/* @fn      HAL_UART_ErrorCallback
+ * @brief   USART2 error: an overrun ends the reception of the flash log
+ *          commands, listen again; a DMA error aborts the chunk or block,
+ *          skip it rather than stall the buffer
+ * */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    if(huart->Instance != USART2)
+    {
+        return;
+    }
+
+    listenFlashLogCommand();
+
+#if (REPORT_USB_CDC == 0)
+    if(tx_busy && huart->gState == HAL_UART_STATE_READY)
+    {
+        port_tx_cplt();
+    }
+#endif
+}
 
 
 /*! ------------------------------------------------------------------------------------------------------------------
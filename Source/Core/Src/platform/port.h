@@ -29,9 +29,16 @@ extern "C" {
 #define EVB1000_LED_SUPPORT 0
 #define EVB1000_LCD_SUPPORT 0
 
+/* Report link of port_tx_msg() and port_tx_block(): 0 - USART2 TX DMA,
+ * 1 - USB CDC, needs the USB device middleware and PA11/PA12 (see port.c) */
+#define REPORT_USB_CDC      0
+
 /* DW IC IRQ (EXTI15_10_IRQ) handler type. */
 typedef void (*port_dwic_isr_t)(void);
 
+/* Report block sent callback type, see port_tx_block(). */
+typedef void (*port_tx_done_t)(const uint8_t *buf);
+
 /*! ------------------------------------------------------------------------------------------------------------------
  * @fn port_set_DWIC_isr()
  *
@@ -194,6 +201,10 @@ void port_DisableEXT_IRQ(void);
 void port_EnableEXT_IRQ(void);
 extern uint32_t     HAL_GetTick(void);
 HAL_StatusTypeDef   flush_report_buff(void);
+HAL_StatusTypeDef   port_tx_msg(uint8_t *str, int len);
+HAL_StatusTypeDef   port_tx_block(const uint8_t *buf, int len, port_tx_done_t done);
+uint32_t            port_tx_dropped(void);
+void                port_tx_cplt(void);
 
 /*! ------------------------------------------------------------------------------------------------------------------
 * @fn wakeup_device_with_io()
@@ -7,7 +7,7 @@
   ******************************************************************************
   */
 #include "pwm_utils.h"
-#include <stdio.h>
+#include "tlog.h"
 
 #define TIM_CLOCK_DIVIDER 100000
 
@@ -24,11 +24,11 @@ void startPwmOutput(TimerParams* params)
   // Checking if the output channel is complimentary (i.e., TIMx_CHxN)
   if (params->isComplimentary)
   {
-    HAL_TIMEx_PWMN_Start_IT(params->timerHandle, params->timerChannel);
+    HAL_TIMEx_PWMN_Start(params->timerHandle, params->timerChannel);
   }
   else
   {
-    HAL_TIM_PWM_Start_IT(params->timerHandle, params->timerChannel);
+    HAL_TIM_PWM_Start(params->timerHandle, params->timerChannel);
   }
 }
 
@@ -44,18 +44,19 @@ void stopPwmOutput(TimerParams* params)
 {
   if (params->isComplimentary)
   {
-    HAL_TIMEx_PWMN_Stop_IT(params->timerHandle, params->timerChannel);
+    HAL_TIMEx_PWMN_Stop(params->timerHandle, params->timerChannel);
   }
   else
   {
-    HAL_TIM_PWM_Stop_IT(params->timerHandle, params->timerChannel);
+    HAL_TIM_PWM_Stop(params->timerHandle, params->timerChannel);
   }
 }
 
-// FUNCTION      : updatePwmSignal
+// FUNCTION      : computePwmRegisters
 // DESCRIPTION   :
-//    Update the frequency and the duty cycle of a running PWM signal on-the-fly
-//    by updating TIMx_ARR and TIMx_CCRx registers.
+//    Computes the TIMx_PSC, TIMx_ARR and TIMx_CCRx values for a frequency and a
+//    duty cycle. Meant to be called at initialization to fill a table that
+//    applyPwmRegisters() can use later without any arithmetic.
 // PARAMETERS    :
 //    TimerParams* params : Parameters related to the timer including
 //                          TIM time base handle structure, TIM channel, and
@@ -63,27 +64,85 @@ void stopPwmOutput(TimerParams* params)
 //    uint32_t freqHz     : Frequency value in Hertz.
 //    uint8_t dutyCycle   : Duty cycle value as a percentage.
 //                          E.x., For a 50% duty cycle, dutyCycle = 50.
-// RETURNS       : None
-void updatePwmSignal(TimerParams* params, uint32_t freqHz, uint8_t dutyCycle)
+//    PwmRegisters* regs  : Computed register values.
+// RETURNS       :
+//    uint8_t : 1 on success, 0 if the parameters are invalid.
+uint8_t computePwmRegisters(TimerParams* params, uint32_t freqHz, uint8_t dutyCycle, PwmRegisters* regs)
 {
-  if (freqHz > params->clockFrequencyHz || dutyCycle > 100 /* 100% */)
+  const uint32_t prescaler = (params->clockFrequencyHz / TIM_CLOCK_DIVIDER) - 1;
+
+  if (freqHz == 0 || freqHz > TIM_CLOCK_DIVIDER / 2 || dutyCycle > 100 /* 100% */)
   {
-	printf("[updatePwmSignal] Error! Invalid parameters.\r\n");
-	return;
+    TLOG("[pwm_utils::computePwmRegisters] Error! Invalid parameters.");
+    return 0;
   }
 
-  const uint32_t prescaler = (params->clockFrequencyHz / TIM_CLOCK_DIVIDER) - 1;
-  // Updating the clock divider by setting the period to the TIMx_PSC register
-  __HAL_TIM_SET_PRESCALER(params->timerHandle, prescaler);
+  // Counts per PWM cycle; the cycle is TIMx_ARR + 1 counts long
+  const uint32_t counts = TIM_CLOCK_DIVIDER / freqHz;
+  if (counts > 0x10000)
+  {
+    TLOG("[pwm_utils::computePwmRegisters] Error! Frequency is too low.");
+    return 0;
+  }
 
-  const uint32_t period = params->clockFrequencyHz / (prescaler * freqHz);
+  // Number of counts the output is active in each cycle
+  const uint32_t activeCounts = counts * dutyCycle / 100;
 
-  // Updating the frequency by setting the period to the TIMx_ARR register
-  __HAL_TIM_SET_AUTORELOAD(params->timerHandle, period);
+  regs->prescaler = prescaler;
+  regs->period = counts - 1;
+  // In PWM mode 2 the output is active from CCR to the end of the cycle, so a
+  // 0% duty cycle is a compare value past TIMx_ARR
+  regs->pulse = params->isPwmMode2 ? counts - activeCounts : activeCounts;
 
-  const float dutyCyclePercentage = dutyCycle / 100.0;
-  const uint16_t pulse = period * dutyCyclePercentage;
+  return 1;
+}
 
-  // Updating the duty cycle by setting the pulse to the TIMx_CCRx register
-  __HAL_TIM_SET_COMPARE(params->timerHandle, params->timerChannel, pulse);
+// FUNCTION      : applyPwmRegisters
+// DESCRIPTION   :
+//    Applies register values computed by computePwmRegisters(). Only the
+//    registers that differ from the current values are written, so switching
+//    between duty cycles of one frequency is a single TIMx_CCRx write.
+//    Safe to call from interrupt context.
+// PARAMETERS    :
+//    TimerParams* params      : Parameters related to the timer.
+//    const PwmRegisters* regs : Register values to be applied.
+// RETURNS       : None
+void applyPwmRegisters(TimerParams* params, const PwmRegisters* regs)
+{
+  TIM_TypeDef* timer = params->timerHandle->Instance;
+
+  if (timer->PSC != regs->prescaler)
+  {
+    // TIMx_PSC is preloaded and takes effect from the next update event
+    timer->PSC = regs->prescaler;
+  }
+  if (timer->ARR != regs->period)
+  {
+    timer->ARR = regs->period;
+  }
+  __HAL_TIM_SET_COMPARE(params->timerHandle, params->timerChannel, regs->pulse);
+}
+
+// FUNCTION      : updatePwmSignal
+// DESCRIPTION   :
+//    Update the frequency and the duty cycle of a running PWM signal on-the-fly
+//    by updating TIMx_ARR and TIMx_CCRx registers. Prefer a table of
+//    computePwmRegisters() results and applyPwmRegisters() when the settings
+//    change often.
+// PARAMETERS    :
+//    TimerParams* params : Parameters related to the timer including
+//                          TIM time base handle structure, TIM channel, and
+//                          clock (APBx) frequency.
+//    uint32_t freqHz     : Frequency value in Hertz.
+//    uint8_t dutyCycle   : Duty cycle value as a percentage.
+//                          E.x., For a 50% duty cycle, dutyCycle = 50.
+// RETURNS       : None
+void updatePwmSignal(TimerParams* params, uint32_t freqHz, uint8_t dutyCycle)
+{
+  PwmRegisters regs;
+
+  if (computePwmRegisters(params, freqHz, dutyCycle, &regs))
+  {
+    applyPwmRegisters(params, &regs);
+  }
 }
@@ -0,0 +1,184 @@
+/*******************************************************************************
+  * File Name          : range_graph.c
+  * Description        :
+  *    Scrolling strip chart of recent distances on the SSD1331 OLED display.
+  *
+  *    Each new sample scrolls the chart one column to the left with the
+  *    controller's COPY_WINDOW command and only the new rightmost column is
+  *    drawn, so the cost of a sample does not depend on the history length.
+  *    The samples are kept in a ring buffer so the chart can be redrawn.
+  *    With the band renderer (SSD1331_BAND_RENDERER) samples are only recorded
+  *    and addRangeGraphToBands() puts the chart on the display list.
+  ******************************************************************************
+  */
+#include "range_graph.h"
+#include "ssd1331_band.h"
+#include "tlog.h"
+
+// Private defines
+#define LAST_COLUMN  (RANGE_GRAPH_WIDTH - 1)
+#define BOTTOM_ROW   (RANGE_GRAPH_POS_Y + RANGE_GRAPH_HEIGHT - 1)
+#define NO_SAMPLE    0xFF // Row value of a column without a sample
+
+// Private global variables
+// Ring buffer of the samples on the chart, oldest at head. Rows and colours are
+// kept in separate arrays so the band renderer can plot them as they are.
+static uint8_t rows[RANGE_GRAPH_WIDTH];       // Display row of the trace, NO_SAMPLE for a gap
+static uint16_t colours[RANGE_GRAPH_WIDTH];
+static uint8_t head = 0;
+
+// FUNCTION      : distanceToRow
+// DESCRIPTION   :
+//    Converts a distance to a display row of the chart.
+// PARAMETERS    :
+//    double distance : Distance in metres.
+// RETURNS       :
+//    uint8_t : Display row, the top row for RANGE_GRAPH_MAX_M and above.
+static uint8_t distanceToRow(double distance)
+{
+  if (distance <= 0.0)
+  {
+    return BOTTOM_ROW;
+  }
+  if (distance >= RANGE_GRAPH_MAX_M)
+  {
+    return RANGE_GRAPH_POS_Y;
+  }
+  return BOTTOM_ROW - (uint8_t)(distance * (RANGE_GRAPH_HEIGHT - 1) / RANGE_GRAPH_MAX_M);
+}
+
+// FUNCTION      : drawColumn
+// DESCRIPTION   :
+//    Draws one column of the chart. The trace is joined to the previous
+//    sample with a vertical segment so steps do not leave gaps.
+// PARAMETERS    :
+//    uint8_t x     : Display column.
+//    uint8_t prev  : Ring buffer index of the sample to the left.
+//    uint8_t curr  : Ring buffer index of the sample of this column.
+// RETURNS       : None
+static void drawColumn(uint8_t x, uint8_t prev, uint8_t curr)
+{
+  uint8_t top = rows[curr];
+  uint8_t bottom = rows[curr];
+
+  ssd1331_fill_rect(x, RANGE_GRAPH_POS_Y, 1, RANGE_GRAPH_HEIGHT, BLACK);
+
+  if (rows[curr] == NO_SAMPLE)
+  {
+    return;
+  }
+
+  if (rows[prev] != NO_SAMPLE)
+  {
+    top = (rows[prev] < rows[curr]) ? rows[prev] : rows[curr];
+    bottom = (rows[prev] > rows[curr]) ? rows[prev] : rows[curr];
+  }
+
+  ssd1331_fill_rect(x, top, 1, bottom - top + 1, colours[curr]);
+}
+
+// FUNCTION      : addSample
+// DESCRIPTION   :
+//    Stores a sample, scrolls the chart left by one column and draws the new
+//    column.
+// PARAMETERS    :
+//    uint8_t row       : Display row of the sample, NO_SAMPLE for a gap.
+//    enum Color colour : Colour of the new part of the trace.
+// RETURNS       : None
+static void addSample(uint8_t row, enum Color colour)
+{
+  const uint8_t prev = (head + LAST_COLUMN) % RANGE_GRAPH_WIDTH;
+  const uint8_t curr = head;
+
+  // The newest sample replaces the oldest, which is the one scrolled off the chart
+  rows[curr] = row;
+  colours[curr] = colour;
+  head = (head + 1) % RANGE_GRAPH_WIDTH;
+
+#if (SSD1331_BAND_RENDERER == 0)
+  ssd1331_copy_window(1, RANGE_GRAPH_POS_Y, LAST_COLUMN, BOTTOM_ROW, 0, RANGE_GRAPH_POS_Y);
+  drawColumn(LAST_COLUMN, prev, curr);
+  // Does not wait for the copy to finish; until then the column is left to the next display frame
+  ssd1331_flush();
+#else
+  (void)prev;
+#endif
+}
+
+// FUNCTION      : initRangeGraph
+// DESCRIPTION   :
+//    Empties the chart and clears its area of the display.
+// PARAMETERS    : None
+// RETURNS       : None
+void initRangeGraph(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < RANGE_GRAPH_WIDTH; i++)
+  {
+    rows[i] = NO_SAMPLE;
+    colours[i] = BLACK;
+  }
+  head = 0;
+
+#if (SSD1331_BAND_RENDERER == 0)
+  ssd1331_fill_rect(0, RANGE_GRAPH_POS_Y, RANGE_GRAPH_WIDTH, RANGE_GRAPH_HEIGHT, BLACK);
+  ssd1331_flush();
+#endif
+}
+
+// FUNCTION      : addRangeGraphSample
+// DESCRIPTION   :
+//    Adds a distance to the right end of the chart.
+// PARAMETERS    :
+//    double distance   : Distance in metres.
+//    enum Color colour : Colour of the new part of the trace.
+// RETURNS       : None
+void addRangeGraphSample(double distance, enum Color colour)
+{
+  addSample(distanceToRow(distance), colour);
+}
+
+// FUNCTION      : addRangeGraphGap
+// DESCRIPTION   :
+//    Adds an empty column to the right end of the chart (Ex: no response).
+// PARAMETERS    : None
+// RETURNS       : None
+void addRangeGraphGap(void)
+{
+  addSample(NO_SAMPLE, BLACK);
+}
+
+// FUNCTION      : redrawRangeGraph
+// DESCRIPTION   :
+//    Redraws the whole chart from the ring buffer (Ex: after clearDisplay()).
+// PARAMETERS    : None
+// RETURNS       : None
+void redrawRangeGraph(void)
+{
+  uint8_t x;
+  uint8_t prev = head;
+
+  for (x = 0; x < RANGE_GRAPH_WIDTH; x++)
+  {
+    const uint8_t curr = (head + x) % RANGE_GRAPH_WIDTH;
+
+    drawColumn(x, prev, curr);
+    prev = curr;
+  }
+  ssd1331_flush();
+}
+
+// FUNCTION      : addRangeGraphToBands
+// DESCRIPTION   :
+//    Adds the chart to the band renderer's display list. The list refers to the
+//    ring buffer, so it shows the latest samples whenever it is rendered.
+// PARAMETERS    : None
+// RETURNS       : None
+void addRangeGraphToBands(void)
+{
+  if (ssd1331_band_plot(0, RANGE_GRAPH_POS_Y, RANGE_GRAPH_HEIGHT, rows, colours, RANGE_GRAPH_WIDTH, head))
+  {
+    TLOG("[range_graph::addRangeGraphToBands] Error! Display list is full");
+  }
+}
@@ -0,0 +1,367 @@
+/*******************************************************************************
+  * File Name          : scheduler.c
+  * Description        :
+  *    Run-to-completion scheduler, see scheduler.h.
+  *
+  *    The cycles of a handler include the interrupts taken while it runs.
+  *    Whether the cycle counter keeps counting in WFI depends on the debug
+  *    configuration, so the time asleep is taken as the wall clock time from
+  *    HAL_GetTick() minus the cycles counted while awake.
+  ******************************************************************************
+  */
+#include "scheduler.h"
+#include "main.h"
+#include "tlog.h"
+
+// Private data types
+typedef struct
+{
+  const char* name;
+  TaskHandler handler;
+  volatile uint32_t events; // Posted and not yet handled
+  uint32_t runs;
+  uint32_t cycles;
+  uint32_t maxCycles;
+} Task;
+
+typedef struct
+{
+  uint8_t running;
+  TaskId task;
+  uint32_t events;
+  uint32_t startTick;
+  uint32_t delayMs;   // Until the next expiry, counted from startTick
+  uint32_t periodMs;  // 0 for a one-shot timer
+} Timer;
+
+// Private global variables
+static Task tasks[SCHED_MAX_TASKS];
+static uint8_t numOfTasks = 0;
+static Timer timers[SCHED_MAX_TIMERS];
+
+// Report window, the cycle counts wrap after 51 s at 84 MHz
+static uint32_t windowStartCycles = 0;
+static uint32_t windowStartTick = 0;
+static uint32_t sleepCycles = 0; // Counted across WFI, 0 when the counter stops in sleep
+
+// FUNCTION      : checkTimers
+// DESCRIPTION   :
+//    Posts the events of the expired timers. A periodic timer which has
+//    fallen more than a period behind, e.g. during a flash erase, fires once
+//    and starts over from now instead of catching up.
+// PARAMETERS    : None
+// RETURNS       : None
+static void checkTimers(void)
+{
+  const uint32_t now = HAL_GetTick();
+  Timer* timer;
+  uint8_t i;
+
+  for (i = 0; i < SCHED_MAX_TIMERS; i++)
+  {
+    timer = &timers[i];
+    if (!timer->running || (now - timer->startTick) < timer->delayMs)
+    {
+      continue;
+    }
+
+    postEvent(timer->task, timer->events);
+
+    if (timer->periodMs == 0)
+    {
+      timer->running = 0;
+      continue;
+    }
+
+    timer->startTick += timer->delayMs;
+    timer->delayMs = timer->periodMs;
+    if ((now - timer->startTick) >= timer->delayMs)
+    {
+      timer->startTick = now;
+    }
+  }
+}
+
+// FUNCTION      : takeEvents
+// DESCRIPTION   : Finds the first task with events pending and clears them.
+// PARAMETERS    :
+//    uint32_t* events : The events of the task.
+// RETURNS       :
+//    TaskId : The task, SCHED_NO_TASK when no task has events.
+static TaskId takeEvents(uint32_t* events)
+{
+  TaskId id;
+
+  for (id = 0; id < numOfTasks; id++)
+  {
+    if (tasks[id].events)
+    {
+      __disable_irq();
+      *events = tasks[id].events;
+      tasks[id].events = 0;
+      __enable_irq();
+      return id;
+    }
+  }
+
+  return SCHED_NO_TASK;
+}
+
+// FUNCTION      : sleepUntilInterrupt
+// DESCRIPTION   :
+//    Sleeps in WFI unless an interrupt has posted an event since the tasks
+//    were checked. Interrupts are masked while checking, so an event posted
+//    right before WFI still wakes the CPU; the interrupt handler runs once
+//    they are unmasked.
+// PARAMETERS    : None
+// RETURNS       : None
+static void sleepUntilInterrupt(void)
+{
+  uint32_t start;
+  uint8_t i;
+
+  __disable_irq();
+  for (i = 0; i < numOfTasks; i++)
+  {
+    if (tasks[i].events)
+    {
+      __enable_irq();
+      return;
+    }
+  }
+
+  start = DWT->CYCCNT;
+  __DSB();
+  __WFI();
+  sleepCycles += DWT->CYCCNT - start;
+  __enable_irq();
+}
+
+// FUNCTION      : toPerMille
+// DESCRIPTION   : Share of the report window in tenths of a percent.
+// PARAMETERS    :
+//    uint32_t cycles       : Cycles.
+//    uint64_t windowCycles : Cycles of the report window, not 0.
+// RETURNS       :
+//    uint32_t : The share, 0 to 1000.
+static uint32_t toPerMille(uint32_t cycles, uint64_t windowCycles)
+{
+  const uint64_t perMille = (uint64_t)cycles * 1000 / windowCycles;
+
+  return (perMille > 1000) ? 1000 : (uint32_t)perMille;
+}
+
+// FUNCTION      : addTask
+// DESCRIPTION   :
+//    Adds a task. Tasks added first run first when several have events
+//    pending, and a task added after one which always has events pending
+//    never runs. Call before runScheduler().
+// PARAMETERS    :
+//    const char* name    : Name for the report, a string literal.
+//    TaskHandler handler : Handler of the task.
+// RETURNS       :
+//    TaskId : The task, SCHED_NO_TASK when SCHED_MAX_TASKS are in use.
+TaskId addTask(const char* name, TaskHandler handler)
+{
+  Task* task;
+
+  if (numOfTasks >= SCHED_MAX_TASKS || handler == NULL)
+  {
+    TLOG("[scheduler::addTask] Error! Cannot add task %s", name);
+    return SCHED_NO_TASK;
+  }
+
+  task = &tasks[numOfTasks];
+  task->name = name;
+  task->handler = handler;
+  task->events = 0;
+  task->runs = 0;
+  task->cycles = 0;
+  task->maxCycles = 0;
+
+  return numOfTasks++;
+}
+
+// FUNCTION      : postEvent
+// DESCRIPTION   :
+//    Posts events to a task, which runs on the next pass of the scheduler.
+//    Can be called from interrupts.
+// PARAMETERS    :
+//    TaskId task     : The task.
+//    uint32_t events : Event bits, defined by the task.
+// RETURNS       : None
+void postEvent(TaskId task, uint32_t events)
+{
+  uint32_t primask;
+
+  if (task >= numOfTasks)
+  {
+    return;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  tasks[task].events |= events;
+  __set_PRIMASK(primask);
+}
+
+// FUNCTION      : startTimer
+// DESCRIPTION   :
+//    Starts a timer which posts events to a task. Call from tasks or before
+//    runScheduler(), not from interrupts.
+// PARAMETERS    :
+//    TaskId task       : The task.
+//    uint32_t events   : Events posted on expiry.
+//    uint32_t delayMs  : Time to the first expiry in milliseconds.
+//    uint32_t periodMs : Time between the following expiries, 0 for once.
+// RETURNS       :
+//    TimerId : The timer, SCHED_NO_TIMER when SCHED_MAX_TIMERS are running.
+TimerId startTimer(TaskId task, uint32_t events, uint32_t delayMs, uint32_t periodMs)
+{
+  Timer* timer;
+  TimerId id;
+
+  for (id = 0; id < SCHED_MAX_TIMERS; id++)
+  {
+    timer = &timers[id];
+    if (!timer->running)
+    {
+      timer->task = task;
+      timer->events = events;
+      timer->startTick = HAL_GetTick();
+      timer->delayMs = delayMs;
+      timer->periodMs = periodMs;
+      timer->running = 1;
+      return id;
+    }
+  }
+
+  TLOG("[scheduler::startTimer] Error! All timers are running");
+  return SCHED_NO_TIMER;
+}
+
+// FUNCTION      : stopTimer
+// DESCRIPTION   : Stops a timer. Events it has already posted stay pending.
+// PARAMETERS    :
+//    TimerId timer : The timer.
+// RETURNS       : None
+void stopTimer(TimerId timer)
+{
+  if (timer < SCHED_MAX_TIMERS)
+  {
+    timers[timer].running = 0;
+  }
+}
+
+// FUNCTION      : getTaskStats
+// DESCRIPTION   : Runtime of a task since the last report.
+// PARAMETERS    :
+//    TaskId task      : The task.
+//    TaskStats* stats : The runtime.
+// RETURNS       :
+//    uint8_t : 0 for an unknown task, 1 otherwise.
+uint8_t getTaskStats(TaskId task, TaskStats* stats)
+{
+  if (task >= numOfTasks)
+  {
+    return 0;
+  }
+
+  stats->name = tasks[task].name;
+  stats->runs = tasks[task].runs;
+  stats->cycles = tasks[task].cycles;
+  stats->maxCycles = tasks[task].maxCycles;
+
+  return 1;
+}
+
+// FUNCTION      : reportSchedulerStats
+// DESCRIPTION   :
+//    Logs the runtime of each task since the last report and starts a new
+//    report window. Call from a task at least every 50 s.
+// PARAMETERS    : None
+// RETURNS       : None
+void reportSchedulerStats(void)
+{
+  const uint32_t cyclesPerUs = SystemCoreClock / 1000000;
+  const uint32_t elapsedMs = HAL_GetTick() - windowStartTick;
+  const uint64_t windowCycles = (uint64_t)elapsedMs * (SystemCoreClock / 1000);
+  uint32_t awakeCycles;
+  uint32_t taskCycles = 0;
+  uint32_t perMille;
+  Task* task;
+  uint8_t i;
+
+  if (elapsedMs == 0)
+  {
+    return;
+  }
+
+  awakeCycles = (DWT->CYCCNT - windowStartCycles) - sleepCycles;
+
+  for (i = 0; i < numOfTasks; i++)
+  {
+    task = &tasks[i];
+    perMille = toPerMille(task->cycles, windowCycles);
+    TLOG("[scheduler] %s: %lu runs, %lu.%lu%% CPU, longest %lu us", task->name, task->runs,
+         perMille / 10, perMille % 10, task->maxCycles / cyclesPerUs);
+    taskCycles += task->cycles;
+    task->runs = 0;
+    task->cycles = 0;
+    task->maxCycles = 0;
+  }
+
+  perMille = 1000 - toPerMille(awakeCycles, windowCycles);
+  TLOG("[scheduler] asleep %lu.%lu%% of %lu ms", perMille / 10, perMille % 10, elapsedMs);
+  perMille = toPerMille((awakeCycles > taskCycles) ? awakeCycles - taskCycles : 0, windowCycles);
+  TLOG("[scheduler] interrupts and scheduler %lu.%lu%% CPU", perMille / 10, perMille % 10);
+
+  windowStartTick = HAL_GetTick();
+  windowStartCycles = DWT->CYCCNT;
+  sleepCycles = 0;
+}
+
+// FUNCTION      : runScheduler
+// DESCRIPTION   :
+//    Runs the tasks as their events are posted, sleeping in between. Call
+//    from main() once the tasks have been added; never returns.
+// PARAMETERS    : None
+// RETURNS       : None
+void runScheduler(void)
+{
+  TaskId id;
+  Task* task;
+  uint32_t events;
+  uint32_t start;
+  uint32_t cycles;
+
+  // The cycle counter is shared with the SPI trace, so it is not reset here
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  windowStartTick = HAL_GetTick();
+  windowStartCycles = DWT->CYCCNT;
+
+  while (1)
+  {
+    checkTimers();
+
+    id = takeEvents(&events);
+    if (id == SCHED_NO_TASK)
+    {
+      sleepUntilInterrupt();
+      continue;
+    }
+
+    task = &tasks[id];
+    start = DWT->CYCCNT;
+    task->handler(events);
+    cycles = DWT->CYCCNT - start;
+
+    task->runs++;
+    task->cycles += cycles;
+    if (cycles > task->maxCycles)
+    {
+      task->maxCycles = cycles;
+    }
+  }
+}
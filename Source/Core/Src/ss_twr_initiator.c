@@ -20,7 +20,9 @@
 
 #include <deca_device_api.h>
 #include <deca_regs.h>
+#include <deca_fastreg.h>
 #include <deca_spi.h>
+#include <deca_spi_trace.h>
 #include <port.h>
 #include <shared_defines.h>
 #include <shared_functions.h>
@@ -31,10 +33,19 @@
 #include "ssd1331.h"
 #include "fonts.h"
 #include "oled_utils.h"
+#include "display_task.h"
+#include "telemetry.h"
+#include "cir_capture.h"
+#include "flash_log.h"
 #include "audio_player.h"
+#include "scheduler.h"
 
-uint8_t countDigits(uint32_t value);
 void handleResult(double distance);
+static void radioHandler(uint32_t events);
+static void telemetryHandler(uint32_t events);
+static void displayHandler(uint32_t events);
+static void audioHandler(uint32_t events);
+static void housekeepingHandler(uint32_t events);
 
 /* Default communication configuration. We use default non-STS DW mode. */
 static dwt_config_t config = {
@@ -53,9 +64,25 @@ static dwt_config_t config = {
         DWT_PDOA_M0      /* PDOA mode off */
 };
 
-/* Inter-ranging delay period, in milliseconds. */
+/* Inter-ranging period, in milliseconds. */
 #define RNG_DELAY_MS 1000
 
+/* Events of the tasks, see scheduler.h. */
+#define RADIO_EVENT_START         0x01 /* Initiate an exchange, every RNG_DELAY_MS */
+#define RADIO_EVENT_POLL          0x02 /* Check whether the exchange has finished */
+#define TELEMETRY_EVENT_RECORD    0x01 /* The record of an exchange is ready */
+#define DISPLAY_EVENT_RESULT      0x01 /* A result was published */
+#define DISPLAY_EVENT_FLUSHED     0x02 /* A display flush has been sent */
+#define DISPLAY_EVENT_FRAME       0x04 /* Frame period, renders a result held back by the frame rate */
+#define AUDIO_EVENT_RESULT        0x01 /* A result was published */
+#define HOUSEKEEPING_EVENT_POLL   0x01 /* Program the flash log, run its dump */
+#define HOUSEKEEPING_EVENT_REPORT 0x02 /* Log the runtime of the tasks */
+
+/* Period of the housekeeping task, in milliseconds. */
+#define HOUSEKEEPING_PERIOD_MS 10
+/* Period of the task runtime report, in milliseconds, 0 for none. At most 50000, see reportSchedulerStats(). */
+#define SCHED_REPORT_MS 10000
+
 /* Default antenna delay values for 64 MHz PRF. See NOTE 2 below. */
 #define TX_ANT_DLY 16385
 #define RX_ANT_DLY 16385
@@ -81,6 +108,16 @@ static uint8_t rx_buffer[RX_BUF_LEN];
 /* Hold copy of status register state here for reference so that it can be examined at a debug breakpoint. */
 static uint32_t status_reg = 0;
 
+/* Status, timestamps and clock offset of the last received frame. */
+static dwt_rxharvest_t harvest;
+
+/* The first path diagnostics are only read for the telemetry records and CIR dumps, they cost a longer SPI burst per frame. */
+#if (TELEMETRY_ENABLE == 1) || (CIR_CAPTURE_ENABLE == 1)
+#define HARVEST_FLAGS DWT_HARVEST_DIAG
+#else
+#define HARVEST_FLAGS 0
+#endif
+
 /* Delay between frames, in UWB microseconds. See NOTE 1 below. */
 #define POLL_TX_TO_RESP_RX_DLY_UUS 240
 /* Receive response timeout. See NOTE 5 below. */
@@ -90,28 +127,53 @@ static uint32_t status_reg = 0;
 static double tof;
 static double distance;
 
-static double prev_distance = 0;
-
 static uint8_t detectionTimeout = 0;
 
+/* State of the ranging task. */
+static enum
+{
+  RADIO_IDLE,
+  RADIO_WAIT_RX
+} radioState = RADIO_IDLE;
+
+/* Record of the last exchange, sent by the telemetry task before the next exchange starts. */
+static TelemetryRecord record;
+
+/* Last result for the audio task. */
+static struct
+{
+  double distance;
+  uint8_t isValid;
+} audioResult;
+
+static TaskId radioTask = SCHED_NO_TASK;
+static TaskId telemetryTask = SCHED_NO_TASK;
+static TaskId displayTask = SCHED_NO_TASK;
+static TaskId audioTask = SCHED_NO_TASK;
+static TaskId housekeepingTask = SCHED_NO_TASK;
+
 /* Values for the PG_DELAY and TX_POWER registers reflect the bandwidth and power of the spectrum at the current
  * temperature. These values can be calibrated prior to taking reference measurements. See NOTE 2 below. */
 extern dwt_txconfig_t txconfig_options;
 
 /*! ------------------------------------------------------------------------------------------------------------------
- * @fn main()
+ * @fn ss_twr_initiator()
  *
- * @brief Application entry point.
+ * @brief Initialises the DW IC and adds the ranging, telemetry, display, audio and housekeeping tasks to the scheduler.
+ *        Returns once done; main() then runs the tasks with runScheduler().
  *
  * @param  none
  *
  * @return none
  */
-int ss_twr_initiator(void)
+void ss_twr_initiator(void)
 {
   /* Configure SPI rate, DW3000 supports up to 38 MHz */
   port_set_dw_ic_spi_fastrate();
 
+  /* Start the SPI transaction tracer (does nothing unless DWT_SPI_TRACE is defined) */
+  spitrace_init();
+
   /* Reset and initialize DW chip. */
   reset_DWIC(); /* Target specific drive of RSTn line into DW3000 low for a period. */
 
@@ -154,151 +216,272 @@ int ss_twr_initiator(void)
     * Note, in real low power applications the LEDs should not be used. */
   dwt_setlnapamode(DWT_LNA_ENABLE | DWT_PA_ENABLE);
 
-  /* Loop forever initiating ranging exchanges. */
-  while (1)
-  {
-    /* Write frame data to DW IC and prepare transmission. See NOTE 7 below. */
-    tx_poll_msg[ALL_MSG_SN_IDX] = frame_seq_nb;
-    dwt_write32bitreg(SYS_STATUS_ID, SYS_STATUS_TXFRS_BIT_MASK);
-    dwt_writetxdata(sizeof(tx_poll_msg), tx_poll_msg, 0); /* Zero offset in TX buffer. */
-    dwt_writetxfctrl(sizeof(tx_poll_msg), 0, 1); /* Zero offset in TX buffer, ranging. */
-
-    /* Start transmission, indicating that a response is expected so that reception is enabled automatically after the frame is sent and the delay
-      * set by dwt_setrxaftertxdelay() has elapsed. */
-    dwt_starttx(DWT_START_TX_IMMEDIATE | DWT_RESPONSE_EXPECTED);
-
-    /* We assume that the transmission is achieved correctly, poll for reception of a frame or error/timeout. See NOTE 8 below. */
-    while (!((status_reg = dwt_read32bitreg(SYS_STATUS_ID)) & (SYS_STATUS_RXFCG_BIT_MASK | SYS_STATUS_ALL_RX_TO | SYS_STATUS_ALL_RX_ERR)))
-    { };
+  /* Results are rendered by the display task, see pollDisplayTask(). */
+  initDisplayTask();
+
+  /* Find the end of the ranging log in flash and mark the start of this session. */
+  initFlashLog();
+
+  /* Tasks in order of priority; the radio first so an exchange is never held up by the others. */
+  radioTask = addTask("radio", radioHandler);
+  telemetryTask = addTask("telemetry", telemetryHandler);
+  displayTask = addTask("display", displayHandler);
+  audioTask = addTask("audio", audioHandler);
+  housekeepingTask = addTask("housekeeping", housekeepingHandler);
+
+  /* Initiate a ranging exchange at once and then every RNG_DELAY_MS. */
+  startTimer(radioTask, RADIO_EVENT_START, 0, RNG_DELAY_MS);
+  startTimer(displayTask, DISPLAY_EVENT_FRAME, 0, 1000 / DISPLAY_FRAME_RATE_HZ);
+  startTimer(housekeepingTask, HOUSEKEEPING_EVENT_POLL, 0, HOUSEKEEPING_PERIOD_MS);
+#if (SCHED_REPORT_MS > 0)
+  startTimer(housekeepingTask, HOUSEKEEPING_EVENT_REPORT, SCHED_REPORT_MS, SCHED_REPORT_MS);
+#endif
+}
 
-    /* Increment frame sequence number after transmission of the poll message (modulo 256). */
-    frame_seq_nb++;
+// FUNCTION      : startExchange
+// DESCRIPTION   :
+//    Sends the poll frame. The DW IC enables the receiver for the response on
+//    its own once the poll has been sent.
+// PARAMETERS    : None
+// RETURNS       : None
+static void startExchange(void)
+{
+  /* Write frame data to DW IC and prepare transmission. See NOTE 7 below. */
+  tx_poll_msg[ALL_MSG_SN_IDX] = frame_seq_nb;
+  dwt_fast_write32(SYS_STATUS_ID, SYS_STATUS_TXFRS_BIT_MASK);
+  dwt_writetxdata(sizeof(tx_poll_msg), tx_poll_msg, 0); /* Zero offset in TX buffer. */
+  dwt_writetxfctrl(sizeof(tx_poll_msg), 0, 1); /* Zero offset in TX buffer, ranging. */
+
+  /* Start transmission, indicating that a response is expected so that reception is enabled automatically after the frame is sent and the delay
+    * set by dwt_setrxaftertxdelay() has elapsed. This is dwt_starttx(DWT_START_TX_IMMEDIATE | DWT_RESPONSE_EXPECTED). */
+  dwt_fast_cmd(CMD_TX_W4R);
+}
 
-    if (status_reg & SYS_STATUS_RXFCG_BIT_MASK)
-    {
-      uint32_t frame_len;
-
-      /* Clear good RX frame event in the DW IC status register. */
-      dwt_write32bitreg(SYS_STATUS_ID, SYS_STATUS_RXFCG_BIT_MASK);
-
-      /* A frame has been received, read it into the local buffer. */
-      frame_len = dwt_read32bitreg(RX_FINFO_ID) & RXFLEN_MASK;
-      if (frame_len <= sizeof(rx_buffer))
-      {
-        dwt_readrxdata(rx_buffer, frame_len, 0);
-
-        /* Check that the frame is the expected response from the companion "SS TWR responder" example.
-          * As the sequence number field of the frame is not relevant, it is cleared to simplify the validation of the frame. */
-        rx_buffer[ALL_MSG_SN_IDX] = 0;
-        if (memcmp(rx_buffer, rx_resp_msg, ALL_MSG_COMMON_LEN) == 0)
-        {
-          uint32_t poll_tx_ts, resp_rx_ts, poll_rx_ts, resp_tx_ts;
-          int32_t rtd_init, rtd_resp;
-          float clockOffsetRatio ;
-
-          /* Retrieve poll transmission and response reception timestamps. See NOTE 9 below. */
-          poll_tx_ts = dwt_readtxtimestamplo32();
-          resp_rx_ts = dwt_readrxtimestamplo32();
-
-          /* Read carrier integrator value and calculate clock offset ratio. See NOTE 11 below. */
-          clockOffsetRatio = ((float)dwt_readclockoffset()) / (uint32_t)(1<<26);
-
-          /* Get timestamps embedded in response message. */
-          resp_msg_get_ts(&rx_buffer[RESP_MSG_POLL_RX_TS_IDX], &poll_rx_ts);
-          resp_msg_get_ts(&rx_buffer[RESP_MSG_RESP_TX_TS_IDX], &resp_tx_ts);
-
-          /* Compute time of flight and distance, using clock offset ratio to correct for differing local and remote clock rates */
-          rtd_init = resp_rx_ts - poll_tx_ts;
-          rtd_resp = resp_tx_ts - poll_rx_ts;
-
-          tof = ((rtd_init - rtd_resp * (1 - clockOffsetRatio)) / 2.0) * DWT_TIME_UNITS;
-          distance = tof * SPEED_OF_LIGHT;
-
-          handleResult(distance);
-        }
-      }
-    }
-    else
+// FUNCTION      : finishExchange
+// DESCRIPTION   :
+//    Reads the response, or the error, computes the distance and hands the
+//    result to the telemetry, display and audio tasks.
+// PARAMETERS    : None
+// RETURNS       : None
+static void finishExchange(void)
+{
+  /* Result of this exchange for the telemetry stream. */
+  memset(&record, 0, sizeof(record));
+
+  /* Increment frame sequence number after transmission of the poll message (modulo 256). */
+  frame_seq_nb++;
+
+  /* Read timestamps, frame and clock offset in a few SPI bursts, then clear the good RX frame or RX error/timeout
+    * events in the DW IC status register. */
+  if (dwt_readrxharvest(&harvest, rx_buffer, sizeof(rx_buffer), HARVEST_FLAGS) == DWT_SUCCESS)
+  {
+    record.clockOffset = harvest.clockOffset;
+    if (harvest.diagValid)
     {
-      /* Clear RX error/timeout events in the DW IC status register. */
-      dwt_write32bitreg(SYS_STATUS_ID, SYS_STATUS_ALL_RX_TO | SYS_STATUS_ALL_RX_ERR);
+      record.flags |= TLM_FLAG_DIAG_VALID;
+      record.fpIndex = harvest.ipatovFpIndex;
+      record.cirPeak = harvest.ipatovPeak;
+      record.cirPower = harvest.ipatovPower;
+      record.accumCount = harvest.ipatovAccumCount;
     }
 
-    if (detectionTimeout >= 1)
+    /* Dump the CIR of the frame while it is still in the accumulator. */
+    captureCir(&config, &harvest);
+
+    /* Check that the frame is the expected response from the companion "SS TWR responder" example.
+      * As the sequence number field of the frame is not relevant, it is cleared to simplify the validation of the frame. */
+    rx_buffer[ALL_MSG_SN_IDX] = 0;
+    if (memcmp(rx_buffer, rx_resp_msg, ALL_MSG_COMMON_LEN) == 0)
     {
-      pauseAudio();
+      uint32_t poll_tx_ts, resp_rx_ts, poll_rx_ts, resp_tx_ts;
+      int32_t rtd_init, rtd_resp;
+      float clockOffsetRatio ;
 
-      // Clear display
-      snprintf(dist_str, sizeof(dist_str), "        ");
-      displayTextOnCorner(dist_str, FONT_LARGE, WHITE, TOP_RIGHT);
-    }
+      /* Retrieve poll transmission and response reception timestamps (lower 32 bits). See NOTE 9 below. */
+      resp_msg_get_ts(harvest.txStamp, &poll_tx_ts);
+      resp_msg_get_ts(harvest.rxStamp, &resp_rx_ts);
 
-    detectionTimeout++;
+      /* Carrier integrator value read with the frame, calculate clock offset ratio. See NOTE 11 below. */
+      clockOffsetRatio = ((float)harvest.clockOffset) / (uint32_t)(1<<26);
 
-    /* Execute a delay between ranging exchanges. */
-    Sleep(RNG_DELAY_MS);
-  }
-}
+      /* Get timestamps embedded in response message. */
+      resp_msg_get_ts(&rx_buffer[RESP_MSG_POLL_RX_TS_IDX], &poll_rx_ts);
+      resp_msg_get_ts(&rx_buffer[RESP_MSG_RESP_TX_TS_IDX], &resp_tx_ts);
 
-void handleResult(double distance)
-{
-  /* Display computed distance on OLED. */
-  if (countDigits(prev_distance) > countDigits(distance))
+      /* Compute time of flight and distance, using clock offset ratio to correct for differing local and remote clock rates */
+      rtd_init = resp_rx_ts - poll_tx_ts;
+      rtd_resp = resp_tx_ts - poll_rx_ts;
+
+      tof = ((rtd_init - rtd_resp * (1 - clockOffsetRatio)) / 2.0) * DWT_TIME_UNITS;
+      distance = tof * SPEED_OF_LIGHT;
+
+      handleResult(distance);
+
+      record.flags |= TLM_FLAG_RANGE_VALID;
+      record.rangeMm = (int32_t)lround(distance * 1000.0);
+    }
+    else
+    {
+      record.flags |= TLM_FLAG_BAD_FRAME;
+    }
+  }
+  else if (status_reg & SYS_STATUS_RXFCG_BIT_MASK)
   {
-    // Clearing the extra digit at the front since otherwise the display will retain it.
-    // Ex: When transitioning from 10 to 9, it will display as 19 without clearing "1".
-    snprintf(dist_str, sizeof(dist_str), " %3.2f m", fabs(distance));
+    /* Good frame, but too long for the receive buffer */
+    record.flags |= TLM_FLAG_BAD_FRAME;
   }
   else
   {
-    snprintf(dist_str, sizeof(dist_str), "%3.2f m", fabs(distance));
+    record.flags |= (status_reg & SYS_STATUS_ALL_RX_TO) ? TLM_FLAG_RX_TIMEOUT : TLM_FLAG_RX_ERROR;
   }
-  prev_distance = distance;
 
-  uint16_t fontColour = GREEN;
+  postEvent(telemetryTask, TELEMETRY_EVENT_RECORD);
 
-  if (distance >= 0.0 && distance <= 0.5)
+  if (detectionTimeout >= 1)
   {
-    fontColour = GREEN;
+    // Clears the readout and pauses the buzzer
+    publishNoRange();
+    audioResult.isValid = 0;
+    postEvent(displayTask, DISPLAY_EVENT_RESULT);
+    postEvent(audioTask, AUDIO_EVENT_RESULT);
   }
-  else if (distance > 0.5  && distance <= 2.0)
+
+  detectionTimeout++;
+}
+
+void handleResult(double distance)
+{
+  /* Hand the distance to the display task; it is shown (with its colour) on the next frame. */
+  publishRange(distance);
+  postEvent(displayTask, DISPLAY_EVENT_RESULT);
+
+  /* And to the audio task, which sets the buzzer cadence. */
+  audioResult.distance = distance;
+  audioResult.isValid = 1;
+  postEvent(audioTask, AUDIO_EVENT_RESULT);
+
+  detectionTimeout = 0;
+}
+
+// FUNCTION      : radioHandler
+// DESCRIPTION   :
+//    Ranging task. Starts an exchange on RADIO_EVENT_START and checks for its
+//    end every millisecond, so the other tasks run and the CPU sleeps while
+//    the DW IC sends the poll and waits for the response.
+// PARAMETERS    :
+//    uint32_t events : RADIO_EVENT_*.
+// RETURNS       : None
+static void radioHandler(uint32_t events)
+{
+  if ((events & RADIO_EVENT_START) && radioState == RADIO_IDLE)
   {
-    fontColour = YELLOW;
+    startExchange();
+    radioState = RADIO_WAIT_RX;
   }
-  else if (distance > 2.0  && distance <= 4.5)
+
+  if (radioState != RADIO_WAIT_RX)
   {
-    fontColour = ORANGE;  // I had to add orange into ssd1331.h
+    return;
   }
-  else if (distance > 4.5)
+
+  /* Check for reception of a frame or error/timeout. See NOTE 8 below.
+    * Each check reads SYS_STATUS and RX_FINFO together so the frame length is known as soon as a frame arrives. */
+  status_reg = dwt_readrxharveststatus(&harvest);
+  if (!(status_reg & (SYS_STATUS_RXFCG_BIT_MASK | SYS_STATUS_ALL_RX_TO | SYS_STATUS_ALL_RX_ERR)))
   {
-    fontColour = RED;
+    startTimer(radioTask, RADIO_EVENT_POLL, 1, 0);
+    return;
   }
 
-  displayTextOnCorner(dist_str, FONT_LARGE, fontColour, TOP_RIGHT);
+  finishExchange();
+  radioState = RADIO_IDLE;
+}
 
-  playAudio(distance);
+// FUNCTION      : telemetryHandler
+// DESCRIPTION   :
+//    Telemetry task. Sends the record of the last exchange and appends it to
+//    the flash log, which the housekeeping task then programs.
+// PARAMETERS    :
+//    uint32_t events : TELEMETRY_EVENT_RECORD.
+// RETURNS       : None
+static void telemetryHandler(uint32_t events)
+{
+  (void)events;
 
-  detectionTimeout = 0;
+  sendTelemetry(&record);
+  appendFlashLog(&record);
+  postEvent(housekeepingTask, HOUSEKEEPING_EVENT_POLL);
 }
 
-// FUNCTION      : countDigits
+// FUNCTION      : displayHandler
 // DESCRIPTION   :
-//    Counts the number of digits in an integer value (Ex: 120 has 3 digits).
+//    Display task. Renders a new result once the frame period allows and
+//    pushes out what was drawn while the previous flush was on the bus.
 // PARAMETERS    :
-//    uint32_t value : Input value.
-// RETURNS       :
-//    uint8_t : Returns the number of digits of the input value.
-uint8_t countDigits(uint32_t value)
+//    uint32_t events : DISPLAY_EVENT_*.
+// RETURNS       : None
+static void displayHandler(uint32_t events)
 {
-  uint8_t numberOfDigits = 0;
+  (void)events;
 
-  while (value != 0)
+  pollDisplayTask();
+}
+
+// FUNCTION      : audioHandler
+// DESCRIPTION   :
+//    Audio task. Sets the buzzer cadence or alert for the last result, or
+//    pauses the buzzer when there was no response.
+// PARAMETERS    :
+//    uint32_t events : AUDIO_EVENT_RESULT.
+// RETURNS       : None
+static void audioHandler(uint32_t events)
+{
+  (void)events;
+
+  if (audioResult.isValid)
+  {
+    playAudio(audioResult.distance);
+  }
+  else
+  {
+    pauseAudio();
+  }
+}
+
+// FUNCTION      : housekeepingHandler
+// DESCRIPTION   :
+//    Housekeeping task. Programs the flash log and runs its dump, and prints
+//    the SPI trace and task runtime reports when they are due. Runs again at
+//    once while the flash log has work left; being the last task, that only
+//    keeps the CPU from sleeping, not the other tasks from running.
+// PARAMETERS    :
+//    uint32_t events : HOUSEKEEPING_EVENT_*.
+// RETURNS       : None
+static void housekeepingHandler(uint32_t events)
+{
+  if (pollFlashLog())
+  {
+    postEvent(housekeepingTask, HOUSEKEEPING_EVENT_POLL);
+  }
+
+  /* Print the SPI bus utilisation summary when it is due (DWT_SPI_TRACE only). */
+  spitrace_poll();
+
+  if (events & HOUSEKEEPING_EVENT_REPORT)
   {
-    value /= 10;
-    numberOfDigits++;
+    reportSchedulerStats();
   }
+}
 
-  return numberOfDigits;
+// FUNCTION      : ssd1331_flush_cplt_callback
+// DESCRIPTION   :
+//    Called from the SPI2 TX complete interrupt when a display flush has
+//    been sent, so anything drawn meanwhile is flushed next.
+// PARAMETERS    : None
+// RETURNS       : None
+void ssd1331_flush_cplt_callback(void)
+{
+  postEvent(displayTask, DISPLAY_EVENT_FLUSHED);
 }
 
 /*****************************************************************************************************************************************************
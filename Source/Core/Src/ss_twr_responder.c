@@ -24,6 +24,9 @@
 #include <shared_functions.h>
 #include <stdio.h>
 #include"ss_twr_responder.h"
+#include "scheduler.h"
+
+static void responderHandler(uint32_t events);
 
 /* Default communication configuration. We use default non-STS DW mode. */
 static dwt_config_t config = {
@@ -78,16 +81,30 @@ static uint64_t resp_tx_ts;
  * temperature. These values can be calibrated prior to taking reference measurements. See NOTE 5 below. */
 extern dwt_txconfig_t txconfig_options;
 
+/* Event of the responder task, see scheduler.h. */
+#define RESPONDER_EVENT_POLL 0x01
+
+/* State of the responder task. */
+static enum
+{
+  RESPONDER_LISTEN,
+  RESPONDER_WAIT_RX,
+  RESPONDER_WAIT_TX
+} responderState = RESPONDER_LISTEN;
+
+static TaskId responderTask = SCHED_NO_TASK;
+
 /*! ------------------------------------------------------------------------------------------------------------------
- * @fn main()
+ * @fn ss_twr_responder()
  *
- * @brief Application entry point.
+ * @brief Initialises the DW IC and adds the responder task to the scheduler. Returns once done; main() then runs the task
+ *        with runScheduler().
  *
  * @param  none
  *
  * @return none
  */
-int ss_twr_responder(void)
+void ss_twr_responder(void)
 {
   /* Configure SPI rate, DW3000 supports up to 38 MHz */
   port_set_dw_ic_spi_fastrate();
@@ -128,79 +145,122 @@ int ss_twr_responder(void)
    * Note, in real low power applications the LEDs should not be used. */
   dwt_setlnapamode(DWT_LNA_ENABLE | DWT_PA_ENABLE);
 
-  /* Loop forever responding to ranging requests. */
-  while (1)
-  {
-    /* Activate reception immediately. */
-    dwt_rxenable(DWT_START_RX_IMMEDIATE);
+  /* Respond to ranging requests from now on. */
+  responderTask = addTask("responder", responderHandler);
+  postEvent(responderTask, RESPONDER_EVENT_POLL);
+}
 
-    /* Poll for reception of a frame or error/timeout. See NOTE 6 below. */
-    while (!((status_reg = dwt_read32bitreg(SYS_STATUS_ID)) & (SYS_STATUS_RXFCG_BIT_MASK | SYS_STATUS_ALL_RX_ERR)))
-    { };
+/*! ------------------------------------------------------------------------------------------------------------------
+ * @fn handlePoll()
+ *
+ * @brief Checks that the received frame is a poll and schedules the response to it.
+ *
+ * @return RESPONDER_WAIT_TX when the response is being sent, RESPONDER_LISTEN otherwise
+ */
+static int handlePoll(void)
+{
+  uint32_t frame_len;
 
-    if (status_reg & SYS_STATUS_RXFCG_BIT_MASK)
+  /* Clear good RX frame event in the DW IC status register. */
+  dwt_write32bitreg(SYS_STATUS_ID, SYS_STATUS_RXFCG_BIT_MASK);
+
+  /* A frame has been received, read it into the local buffer. */
+  frame_len = dwt_read32bitreg(RX_FINFO_ID) & RXFLEN_MASK;
+  if (frame_len <= sizeof(rx_buffer))
+  {
+    dwt_readrxdata(rx_buffer, frame_len, 0);
+
+    /* Check that the frame is a poll sent by "SS TWR initiator" example.
+     * As the sequence number field of the frame is not relevant, it is cleared to simplify the validation of the frame. */
+    rx_buffer[ALL_MSG_SN_IDX] = 0;
+    if (memcmp(rx_buffer, rx_poll_msg, ALL_MSG_COMMON_LEN) == 0)
     {
-      uint32_t frame_len;
+      uint32_t resp_tx_time;
+      int ret;
+
+      /* Retrieve poll reception timestamp. */
+      poll_rx_ts = get_rx_timestamp_u64();
+
+      /* Compute response message transmission time. See NOTE 7 below. */
+      resp_tx_time = (poll_rx_ts + (POLL_RX_TO_RESP_TX_DLY_UUS * UUS_TO_DWT_TIME)) >> 8;
+      dwt_setdelayedtrxtime(resp_tx_time);
+
+      /* Response TX timestamp is the transmission time we programmed plus the antenna delay. */
+      resp_tx_ts = (((uint64_t)(resp_tx_time & 0xFFFFFFFEUL)) << 8) + TX_ANT_DLY;
+
+      /* Write all timestamps in the final message. See NOTE 8 below. */
+      resp_msg_set_ts(&tx_resp_msg[RESP_MSG_POLL_RX_TS_IDX], poll_rx_ts);
+      resp_msg_set_ts(&tx_resp_msg[RESP_MSG_RESP_TX_TS_IDX], resp_tx_ts);
 
-      /* Clear good RX frame event in the DW IC status register. */
-      dwt_write32bitreg(SYS_STATUS_ID, SYS_STATUS_RXFCG_BIT_MASK);
+      /* Write and send the response message. See NOTE 9 below. */
+      tx_resp_msg[ALL_MSG_SN_IDX] = frame_seq_nb;
+      dwt_writetxdata(sizeof(tx_resp_msg), tx_resp_msg, 0); /* Zero offset in TX buffer. */
+      dwt_writetxfctrl(sizeof(tx_resp_msg), 0, 1); /* Zero offset in TX buffer, ranging. */
+      ret = dwt_starttx(DWT_START_TX_DELAYED);
 
-      /* A frame has been received, read it into the local buffer. */
-      frame_len = dwt_read32bitreg(RX_FINFO_ID) & RXFLEN_MASK;
-      if (frame_len <= sizeof(rx_buffer))
+      /* If dwt_starttx() returns an error, abandon this ranging exchange and proceed to the next one. See NOTE 10 below. */
+      if (ret == DWT_SUCCESS)
       {
-        dwt_readrxdata(rx_buffer, frame_len, 0);
-
-        /* Check that the frame is a poll sent by "SS TWR initiator" example.
-         * As the sequence number field of the frame is not relevant, it is cleared to simplify the validation of the frame. */
-        rx_buffer[ALL_MSG_SN_IDX] = 0;
-        if (memcmp(rx_buffer, rx_poll_msg, ALL_MSG_COMMON_LEN) == 0)
-        {
-          uint32_t resp_tx_time;
-          int ret;
-
-          /* Retrieve poll reception timestamp. */
-          poll_rx_ts = get_rx_timestamp_u64();
-
-          /* Compute response message transmission time. See NOTE 7 below. */
-          resp_tx_time = (poll_rx_ts + (POLL_RX_TO_RESP_TX_DLY_UUS * UUS_TO_DWT_TIME)) >> 8;
-          dwt_setdelayedtrxtime(resp_tx_time);
-
-          /* Response TX timestamp is the transmission time we programmed plus the antenna delay. */
-          resp_tx_ts = (((uint64_t)(resp_tx_time & 0xFFFFFFFEUL)) << 8) + TX_ANT_DLY;
-
-          /* Write all timestamps in the final message. See NOTE 8 below. */
-          resp_msg_set_ts(&tx_resp_msg[RESP_MSG_POLL_RX_TS_IDX], poll_rx_ts);
-          resp_msg_set_ts(&tx_resp_msg[RESP_MSG_RESP_TX_TS_IDX], resp_tx_ts);
-
-          /* Write and send the response message. See NOTE 9 below. */
-          tx_resp_msg[ALL_MSG_SN_IDX] = frame_seq_nb;
-          dwt_writetxdata(sizeof(tx_resp_msg), tx_resp_msg, 0); /* Zero offset in TX buffer. */
-          dwt_writetxfctrl(sizeof(tx_resp_msg), 0, 1); /* Zero offset in TX buffer, ranging. */
-          ret = dwt_starttx(DWT_START_TX_DELAYED);
-
-          /* If dwt_starttx() returns an error, abandon this ranging exchange and proceed to the next one. See NOTE 10 below. */
-          if (ret == DWT_SUCCESS)
-          {
-            /* Poll DW IC until TX frame sent event set. See NOTE 6 below. */
-            while (!(dwt_read32bitreg(SYS_STATUS_ID) & SYS_STATUS_TXFRS_BIT_MASK))
-            { };
-
-            /* Clear TXFRS event. */
-            dwt_write32bitreg(SYS_STATUS_ID, SYS_STATUS_TXFRS_BIT_MASK);
-
-            /* Increment frame sequence number after transmission of the poll message (modulo 256). */
-            frame_seq_nb++;
-          }
-        }
+        return RESPONDER_WAIT_TX;
       }
     }
-    else
+  }
+
+  return RESPONDER_LISTEN;
+}
+
+/*! ------------------------------------------------------------------------------------------------------------------
+ * @fn responderHandler()
+ *
+ * @brief Responder task. The response has to be scheduled within POLL_RX_TO_RESP_TX_DLY_UUS of the poll, too short for
+ *        the 1 ms scheduler timers, so the task checks the DW IC on every pass and posts itself again. The CPU never
+ *        sleeps, and as the task always has an event pending, tasks added after it would never run: it must stay the
+ *        last task, here the only one.
+ *
+ * @param events - RESPONDER_EVENT_POLL
+ */
+static void responderHandler(uint32_t events)
+{
+  (void)events;
+
+  switch (responderState)
+  {
+  case RESPONDER_LISTEN:
+    /* Activate reception immediately. */
+    dwt_rxenable(DWT_START_RX_IMMEDIATE);
+    responderState = RESPONDER_WAIT_RX;
+    break;
+
+  case RESPONDER_WAIT_RX:
+    /* Check for reception of a frame or error/timeout. See NOTE 6 below. */
+    status_reg = dwt_read32bitreg(SYS_STATUS_ID);
+    if (status_reg & SYS_STATUS_RXFCG_BIT_MASK)
+    {
+      responderState = handlePoll();
+    }
+    else if (status_reg & SYS_STATUS_ALL_RX_ERR)
     {
       /* Clear RX error events in the DW IC status register. */
       dwt_write32bitreg(SYS_STATUS_ID, SYS_STATUS_ALL_RX_ERR);
+      responderState = RESPONDER_LISTEN;
     }
+    break;
+
+  case RESPONDER_WAIT_TX:
+    /* Check for the TX frame sent event. See NOTE 6 below. */
+    if (dwt_read32bitreg(SYS_STATUS_ID) & SYS_STATUS_TXFRS_BIT_MASK)
+    {
+      /* Clear TXFRS event. */
+      dwt_write32bitreg(SYS_STATUS_ID, SYS_STATUS_TXFRS_BIT_MASK);
+
+      /* Increment frame sequence number after transmission of the poll message (modulo 256). */
+      frame_seq_nb++;
+      responderState = RESPONDER_LISTEN;
+    }
+    break;
   }
+
+  postEvent(responderTask, RESPONDER_EVENT_POLL);
 }
 
 /*****************************************************************************************************************************************************
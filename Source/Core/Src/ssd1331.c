@@ -20,6 +20,7 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 
 
 /* Includes ------------------------------------------------------------------*/
@@ -34,6 +35,7 @@ extern SPI_HandleTypeDef hspi2;
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
 #define MIN(a,b)  (((a) < (b)) ? (a) : (b))
+#define MAX(a,b)  (((a) > (b)) ? (a) : (b))
 
 //#define SSD1331_RES_Pin GPIO_PIN_0
 //#define SSD1331_RES_GPIO_Port GPIOB
@@ -52,6 +54,7 @@ extern SPI_HandleTypeDef hspi2;
 #define __SSD1331_CS_CLR()      HAL_GPIO_WritePin(SSD1331_CS_GPIO_Port, SSD1331_CS_Pin, 0)
 
 #define __SSD1331_WRITE_BYTE(__DATA) HAL_SPI_Transmit(&hspi2, &(__DATA),1,100)
+#define __SSD1331_WRITE_BUF(__BUF, __LEN) HAL_SPI_Transmit(&hspi2, (uint8_t *)(__BUF), (__LEN), HAL_MAX_DELAY)
 
 
 
@@ -59,8 +62,6 @@ extern SPI_HandleTypeDef hspi2;
 #define SSD1331_CMD                     0
 #define SSD1331_DATA                    1
                  
-#define OLED_WIDTH                      96
-#define OLED_HEIGHT                     64
 
 /* Private macro -------------------------------------------------------------*/
 #define DRAW_LINE                       0x21
@@ -105,7 +106,80 @@ extern SPI_HandleTypeDef hspi2;
 #define SET_PRECHARGE_VOLTAGE           0xBB
 #define SET_V_VOLTAGE                   0xBE
 
+#define SSD1331_DIRTY_RECTS             4     /* dirty rectangles tracked before they are merged */
+
+#if (SSD1331_USE_DMA == 1)
+#define SSD1331_FB_COUNT                2     /* one framebuffer is drawn into while the other is sent */
+#else
+#define SSD1331_FB_COUNT                1
+#endif
+
+#if (SSD1331_COLOUR_DEPTH == 16)
+#define SSD1331_REMAP_FORMAT            0x72  /* 65k colour format 1, COM split, reversed scan, BGR */
+#else
+#define SSD1331_REMAP_FORMAT            0x32  /* as 0x72 with 256 colour format */
+#endif
+
+/* Graphic acceleration commands execute in the controller after their last byte has been received;
+   nothing else may be written to it until they are done */
+#define SSD1331_ACCEL_FILL_MS           3     /* DRAW_RECTANGLE / CLEAR_WINDOW */
+#define SSD1331_ACCEL_LINE_MS           1     /* DRAW_LINE */
+#define SSD1331_ACCEL_MIN_AREA          128   /* smaller fills are cheaper through the framebuffer */
+
+#define SSD1331_GLYPH_CACHE             8     /* pre-expanded glyphs kept (LRU) */
+#define SSD1331_GLYPH_MAX_PIXELS        (FONT_1608 / 2 * FONT_1608)
+
+/* Colour as the three colour bytes of the acceleration commands (6 bits each, scaled up from the pixel format) */
+#if (SSD1331_COLOUR_DEPTH == 16)
+#define __SSD1331_ACCEL_RGB(__HW)       (uint8_t)(((__HW) >> 11) << 1), (uint8_t)(((__HW) >> 5) & 0x3F), (uint8_t)(((__HW) & 0x1F) << 1)
+#else
+#define __SSD1331_ACCEL_RGB(__HW)       (uint8_t)((((__HW) >> 5) & 0x07) << 3), (uint8_t)((((__HW) >> 2) & 0x07) << 3), (uint8_t)(((__HW) & 0x03) << 4)
+#endif
+
 /* Private variables ---------------------------------------------------------*/
+#if (SSD1331_FRAMEBUFFER == 1)
+typedef struct {
+	uint8_t chX0, chY0, chX1, chY1;     /* inclusive */
+} ssd1331_rect_t;
+
+static ssd1331_pixel_t s_hwFrameBuffer[SSD1331_FB_COUNT][OLED_HEIGHT][OLED_WIDTH];
+static ssd1331_pixel_t (*s_phwDraw)[OLED_WIDTH] = s_hwFrameBuffer[0];     /* framebuffer the primitives draw into */
+static ssd1331_rect_t s_tDirty[SSD1331_DIRTY_RECTS];
+static uint8_t s_chDirtyCount = 0;
+
+#if (SSD1331_USE_DMA == 1)
+/* Transfer in progress, advanced from HAL_SPI_TxCpltCallback() */
+static ssd1331_pixel_t (*s_phwSend)[OLED_WIDTH];                          /* framebuffer being sent */
+static ssd1331_rect_t s_tSend[SSD1331_DIRTY_RECTS];
+static uint8_t s_chSendCount = 0;
+static uint8_t s_chSendIndex = 0;
+static uint8_t s_chSendRow = 0;
+static uint8_t s_chSendCmd[6];
+static volatile uint8_t s_chBusy = 0;
+
+typedef enum {
+	SSD1331_PHASE_WINDOW = 0,           /* column/row window command */
+	SSD1331_PHASE_DATA                  /* pixel data of one row or of a full-width rectangle */
+} ssd1331_phase_t;
+static ssd1331_phase_t s_tPhase;
+#endif
+#endif
+
+static uint32_t s_wAccelReadyTick = 0;
+static uint8_t s_chAccelPending = 0;
+
+/* A character expanded to framebuffer pixels (rows of chSize / 2 pixels), ready to be copied or streamed */
+typedef struct {
+	uint8_t chChr;
+	uint8_t chSize;                     /* 0: entry unused */
+	uint16_t hwColor;
+	uint32_t wLastUse;
+	ssd1331_pixel_t hwPixels[SSD1331_GLYPH_MAX_PIXELS];
+} ssd1331_glyph_t;
+
+static ssd1331_glyph_t s_tGlyphCache[SSD1331_GLYPH_CACHE];
+static uint32_t s_wGlyphClock = 0;
+
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
 
@@ -124,8 +198,34 @@ extern SPI_HandleTypeDef hspi2;
    *						   1: Writes to the display data ram
    * @retval None
  **/
+/**
+  * @brief  Waits until the last graphic acceleration command has been executed
+**/
+static void ssd1331_accel_wait(void)
+{
+	while (s_chAccelPending && (int32_t)(HAL_GetTick() - s_wAccelReadyTick) < 0);
+	s_chAccelPending = 0;
+}
+
+#if (SSD1331_FRAMEBUFFER == 1) && (SSD1331_USE_DMA == 1)
+/**
+  * @brief  Returns 1 while the last graphic acceleration command may still be executing
+**/
+static uint8_t ssd1331_accel_pending(void)
+{
+	if (s_chAccelPending && (int32_t)(HAL_GetTick() - s_wAccelReadyTick) >= 0) {
+		s_chAccelPending = 0;
+	}
+	return s_chAccelPending;
+}
+#endif
+
 static void ssd1331_write_byte(uint8_t chData, uint8_t chCmd) 
 {
+#if (SSD1331_USE_DMA == 1)
+	while (s_chBusy);
+#endif
+	ssd1331_accel_wait();
 	if (chCmd) {
 	 	__SSD1331_DC_SET();
 	} else {
@@ -139,40 +239,399 @@ static void ssd1331_write_byte(uint8_t chData, uint8_t chCmd)
 	__SSD1331_DC_SET();
 }
 
+/**
+  * @brief  Writes a command sequence with a single chip select assertion
+  * @param  pchCmd: command bytes
+  * @param  chLen: number of bytes
+  * @retval None
+**/
+static void ssd1331_write_cmds(const uint8_t *pchCmd, uint8_t chLen)
+{
+#if (SSD1331_USE_DMA == 1)
+	while (s_chBusy);
+#endif
+	ssd1331_accel_wait();
+	__SSD1331_DC_CLR();
+	__SSD1331_CS_CLR();
+	__SSD1331_WRITE_BUF(pchCmd, chLen);
+	__SSD1331_CS_SET();
+	__SSD1331_DC_SET();
+}
+
+/**
+  * @brief  Sets the column/row window that the following display data fills
+**/
+static void ssd1331_set_window(uint8_t chX0, uint8_t chY0, uint8_t chX1, uint8_t chY1)
+{
+	uint8_t chCmd[6] = { SET_COLUMN_ADDRESS, chX0, chX1, SET_ROW_ADDRESS, chY0, chY1 };
+
+	ssd1331_write_cmds(chCmd, sizeof(chCmd));
+}
+
+/**
+  * @brief  Sends a graphic acceleration command sequence. The next write to the display
+  *         waits for chMs to pass instead of this call.
+**/
+static void ssd1331_accel_cmds(const uint8_t *pchCmd, uint8_t chLen, uint8_t chMs)
+{
+	ssd1331_write_cmds(pchCmd, chLen);
+	s_wAccelReadyTick = HAL_GetTick() + chMs + 1;
+	s_chAccelPending = 1;
+}
+
+/**
+  * @brief  Sends pixel data for a window straight to the display, bypassing the framebuffer.
+  *         Blocking; waits for a DMA flush or acceleration command in progress first.
+  * @param  chX0, chY0, chX1, chY1: window, inclusive
+  * @param  pData: pixels in bus order (ssd1331_pixel_t, see __SSD1331_PIXEL)
+  * @param  hwLen: number of bytes
+  * @retval None
+**/
+void ssd1331_write_window(uint8_t chX0, uint8_t chY0, uint8_t chX1, uint8_t chY1, const void *pData, uint16_t hwLen)
+{
+	ssd1331_set_window(chX0, chY0, chX1, chY1);
+
+	__SSD1331_DC_SET();
+	__SSD1331_CS_CLR();
+	__SSD1331_WRITE_BUF(pData, hwLen);
+	__SSD1331_CS_SET();
+}
+
+#if (SSD1331_FRAMEBUFFER == 1)
+/**
+  * @brief  Adds a rectangle (clipped to the screen) to the dirty list. Overlapping or touching
+  *         rectangles are merged; when the list is full the new one is merged into the entry
+  *         that grows the least.
+**/
+static void ssd1331_mark_dirty(int nX0, int nY0, int nX1, int nY1)
+{
+	uint8_t i, chBest = 0;
+	int nBestGrowth = 0x7FFFFFFF;
+	ssd1331_rect_t *ptRect;
+
+	nX0 = MAX(nX0, 0);
+	nY0 = MAX(nY0, 0);
+	nX1 = MIN(nX1, OLED_WIDTH - 1);
+	nY1 = MIN(nY1, OLED_HEIGHT - 1);
+	if (nX0 > nX1 || nY0 > nY1) {
+		return;
+	}
+
+	for (i = 0; i < s_chDirtyCount; i ++) {
+		ptRect = &s_tDirty[i];
+		if (nX0 <= ptRect->chX1 + 1 && nX1 + 1 >= ptRect->chX0 &&
+		    nY0 <= ptRect->chY1 + 1 && nY1 + 1 >= ptRect->chY0) {
+			chBest = i;
+			nBestGrowth = 0;
+			break;
+		}
+	}
+
+	if (nBestGrowth != 0 && s_chDirtyCount < SSD1331_DIRTY_RECTS) {
+		ptRect = &s_tDirty[s_chDirtyCount ++];
+		ptRect->chX0 = nX0;
+		ptRect->chY0 = nY0;
+		ptRect->chX1 = nX1;
+		ptRect->chY1 = nY1;
+		return;
+	}
+
+	if (nBestGrowth != 0) {
+		for (i = 0; i < s_chDirtyCount; i ++) {
+			ptRect = &s_tDirty[i];
+			int nGrowth = (MAX(nX1, ptRect->chX1) - MIN(nX0, ptRect->chX0) + 1) * (MAX(nY1, ptRect->chY1) - MIN(nY0, ptRect->chY0) + 1)
+			            - (ptRect->chX1 - ptRect->chX0 + 1) * (ptRect->chY1 - ptRect->chY0 + 1);
+			if (nGrowth < nBestGrowth) {
+				nBestGrowth = nGrowth;
+				chBest = i;
+			}
+		}
+	}
+
+	ptRect = &s_tDirty[chBest];
+	ptRect->chX0 = MIN(nX0, ptRect->chX0);
+	ptRect->chY0 = MIN(nY0, ptRect->chY0);
+	ptRect->chX1 = MAX(nX1, ptRect->chX1);
+	ptRect->chY1 = MAX(nY1, ptRect->chY1);
+}
+
+static inline void ssd1331_put_pixel(uint8_t chXpos, uint8_t chYpos, uint16_t hwColor)
+{
+	if (chXpos < OLED_WIDTH && chYpos < OLED_HEIGHT) {
+		s_phwDraw[chYpos][chXpos] = __SSD1331_PIXEL(hwColor);
+	}
+}
+
+/**
+  * @brief  Writes a pixel drawn by an acceleration command into every framebuffer, so the
+  *         framebuffers match the display without the pixel being sent again.
+**/
+static inline void ssd1331_put_pixel_all(uint8_t chXpos, uint8_t chYpos, uint16_t hwColor)
+{
+	uint8_t i;
+
+	for (i = 0; i < SSD1331_FB_COUNT; i ++) {
+		s_hwFrameBuffer[i][chYpos][chXpos] = __SSD1331_PIXEL(hwColor);
+	}
+}
+
+/**
+  * @brief  Fills a rectangle (inclusive, on screen) of every framebuffer and drops the dirty
+  *         rectangles it covers: the display already shows the fill.
+**/
+static void ssd1331_fill_all(uint8_t chX0, uint8_t chY0, uint8_t chX1, uint8_t chY1, uint16_t hwColor)
+{
+	uint8_t i, x, y;
+	ssd1331_rect_t *ptRect;
+
+	for (i = 0; i < SSD1331_FB_COUNT; i ++) {
+		for (y = chY0; y <= chY1; y ++) {
+			for (x = chX0; x <= chX1; x ++) {
+				s_hwFrameBuffer[i][y][x] = __SSD1331_PIXEL(hwColor);
+			}
+		}
+	}
+
+	for (i = 0; i < s_chDirtyCount; ) {
+		ptRect = &s_tDirty[i];
+		if (ptRect->chX0 >= chX0 && ptRect->chX1 <= chX1 && ptRect->chY0 >= chY0 && ptRect->chY1 <= chY1) {
+			*ptRect = s_tDirty[-- s_chDirtyCount];
+		} else {
+			i ++;
+		}
+	}
+}
+
+#if (SSD1331_USE_DMA == 1)
+/**
+  * @brief  Starts the DMA transfer of the current phase of the send list. Runs from thread
+  *         context for the first rectangle and from the transfer complete interrupt after that.
+  *         Chip select stays low for all the rows of a rectangle.
+  * @retval None
+**/
+static void ssd1331_send_next(void)
+{
+	ssd1331_rect_t *ptRect = &s_tSend[s_chSendIndex];
+	uint8_t chWidth = ptRect->chX1 - ptRect->chX0 + 1;
+	HAL_StatusTypeDef tStatus;
+
+	if (SSD1331_PHASE_WINDOW == s_tPhase) {
+		s_chSendCmd[0] = SET_COLUMN_ADDRESS;
+		s_chSendCmd[1] = ptRect->chX0;
+		s_chSendCmd[2] = ptRect->chX1;
+		s_chSendCmd[3] = SET_ROW_ADDRESS;
+		s_chSendCmd[4] = ptRect->chY0;
+		s_chSendCmd[5] = ptRect->chY1;
+		__SSD1331_DC_CLR();
+		__SSD1331_CS_CLR();
+		tStatus = HAL_SPI_Transmit_DMA(&hspi2, s_chSendCmd, sizeof(s_chSendCmd));
+	} else if (chWidth == OLED_WIDTH) {
+		tStatus = HAL_SPI_Transmit_DMA(&hspi2, (uint8_t *)&s_phwSend[ptRect->chY0][0],
+		                               (uint16_t)(ptRect->chY1 - ptRect->chY0 + 1) * OLED_WIDTH * SSD1331_BPP);
+	} else {
+		tStatus = HAL_SPI_Transmit_DMA(&hspi2, (uint8_t *)&s_phwSend[s_chSendRow][ptRect->chX0], (uint16_t)chWidth * SSD1331_BPP);
+	}
+
+	if (HAL_OK != tStatus) {
+		__SSD1331_CS_SET();
+		__SSD1331_DC_SET();
+		s_chBusy = 0;
+	}
+}
+
+/**
+  * @brief  Swaps the framebuffers and starts sending the dirty rectangles of the one drawn
+  *         so far by DMA. Returns at once; if the previous flush is still being sent or an
+  *         acceleration command is still executing nothing is done and the dirty rectangles
+  *         are kept for the next call.
+  * @retval None
+**/
+void ssd1331_flush(void)
+{
+	uint8_t i, chRow, chWidth;
+	ssd1331_pixel_t (*phwNext)[OLED_WIDTH];
+	ssd1331_rect_t *ptRect;
+
+	if (s_chBusy || 0 == s_chDirtyCount || ssd1331_accel_pending()) {
+		return;
+	}
+
+	/* The other framebuffer matches this one except for the rectangles being flushed now
+	   (everything older was copied across by the previous flush), so bring those over
+	   before drawing continues in it. */
+	phwNext = (s_phwDraw == s_hwFrameBuffer[0]) ? s_hwFrameBuffer[1] : s_hwFrameBuffer[0];
+	for (i = 0; i < s_chDirtyCount; i ++) {
+		ptRect = &s_tDirty[i];
+		chWidth = ptRect->chX1 - ptRect->chX0 + 1;
+		for (chRow = ptRect->chY0; chRow <= ptRect->chY1; chRow ++) {
+			memcpy(&phwNext[chRow][ptRect->chX0], &s_phwDraw[chRow][ptRect->chX0], (size_t)chWidth * SSD1331_BPP);
+		}
+		s_tSend[i] = *ptRect;
+	}
+
+	s_phwSend = s_phwDraw;
+	s_phwDraw = phwNext;
+	s_chSendCount = s_chDirtyCount;
+	s_chSendIndex = 0;
+	s_chDirtyCount = 0;
+	s_tPhase = SSD1331_PHASE_WINDOW;
+	s_chBusy = 1;
+	ssd1331_send_next();
+}
+
+/**
+  * @brief  Returns 1 while a flush is being sent by DMA
+**/
+uint8_t ssd1331_is_busy(void)
+{
+	return s_chBusy;
+}
+
+/**
+  * @brief  Called from interrupt context when a flush has been sent completely
+**/
+__weak void ssd1331_flush_cplt_callback(void)
+{
+}
+
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+	ssd1331_rect_t *ptRect;
+
+	if (hspi->Instance != SPI2 || !s_chBusy) {
+		return;
+	}
+
+	ptRect = &s_tSend[s_chSendIndex];
+	if (SSD1331_PHASE_WINDOW == s_tPhase) {
+		/* HAL has waited for BSY to clear, so the last command byte is latched */
+		__SSD1331_CS_SET();
+		__SSD1331_DC_SET();
+		__SSD1331_CS_CLR();
+		s_tPhase = SSD1331_PHASE_DATA;
+		s_chSendRow = ptRect->chY0;
+		ssd1331_send_next();
+		return;
+	}
+
+	if ((ptRect->chX1 - ptRect->chX0 + 1) != OLED_WIDTH && s_chSendRow < ptRect->chY1) {
+		s_chSendRow ++;
+		ssd1331_send_next();
+		return;
+	}
+
+	__SSD1331_CS_SET();
+	if (++ s_chSendIndex < s_chSendCount) {
+		s_tPhase = SSD1331_PHASE_WINDOW;
+		ssd1331_send_next();
+		return;
+	}
+
+	s_chBusy = 0;
+	ssd1331_flush_cplt_callback();
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi)
+{
+	if (hspi->Instance != SPI2) {
+		return;
+	}
+	__SSD1331_CS_SET();
+	__SSD1331_DC_SET();
+	s_chBusy = 0;
+}
+#else
+/**
+  * @brief  Sends the dirty rectangles of the framebuffer to the display. Each rectangle is one
+  *         column/row window command followed by one data burst (chip select held low across
+  *         the rows; full-width rectangles are a single contiguous transfer).
+  * @retval None
+**/
+void ssd1331_flush(void)
+{
+	uint8_t i, chRow, chWidth;
+	ssd1331_rect_t *ptRect;
+
+	for (i = 0; i < s_chDirtyCount; i ++) {
+		ptRect = &s_tDirty[i];
+		chWidth = ptRect->chX1 - ptRect->chX0 + 1;
+
+		ssd1331_set_window(ptRect->chX0, ptRect->chY0, ptRect->chX1, ptRect->chY1);
+
+		__SSD1331_DC_SET();
+		__SSD1331_CS_CLR();
+		if (chWidth == OLED_WIDTH) {
+			__SSD1331_WRITE_BUF(&s_phwDraw[ptRect->chY0][0], (uint16_t)(ptRect->chY1 - ptRect->chY0 + 1) * OLED_WIDTH * SSD1331_BPP);
+		} else {
+			for (chRow = ptRect->chY0; chRow <= ptRect->chY1; chRow ++) {
+				__SSD1331_WRITE_BUF(&s_phwDraw[chRow][ptRect->chX0], (uint16_t)chWidth * SSD1331_BPP);
+			}
+		}
+		__SSD1331_CS_SET();
+	}
+	s_chDirtyCount = 0;
+}
+
+uint8_t ssd1331_is_busy(void)
+{
+	return 0;
+}
+#endif
+#else
+#define ssd1331_mark_dirty(nX0, nY0, nX1, nY1)
+#define ssd1331_put_pixel(chXpos, chYpos, hwColor)  ssd1331_draw_point(chXpos, chYpos, hwColor)
+
+void ssd1331_flush(void)
+{
+}
+
+uint8_t ssd1331_is_busy(void)
+{
+	return 0;
+}
+#endif
+
 void ssd1331_draw_point(uint8_t chXpos, uint8_t chYpos, uint16_t hwColor) 
 {
 	if (chXpos >= OLED_WIDTH || chYpos >= OLED_HEIGHT) {
 		return;
 	}
 
-    //set column point
-    ssd1331_write_byte(SET_COLUMN_ADDRESS, SSD1331_CMD);
-    ssd1331_write_byte(chXpos, SSD1331_CMD);
-    ssd1331_write_byte(OLED_WIDTH - 1, SSD1331_CMD);
-    //set row point
-    ssd1331_write_byte(SET_ROW_ADDRESS, SSD1331_CMD);
-    ssd1331_write_byte(chYpos, SSD1331_CMD);
-    ssd1331_write_byte(OLED_HEIGHT - 1, SSD1331_CMD);
+#if (SSD1331_FRAMEBUFFER == 1)
+	s_phwDraw[chYpos][chXpos] = __SSD1331_PIXEL(hwColor);
+	ssd1331_mark_dirty(chXpos, chYpos, chXpos, chYpos);
+#else
+    //set column and row point
+    ssd1331_set_window(chXpos, chYpos, OLED_WIDTH - 1, OLED_HEIGHT - 1);
     
+#if (SSD1331_COLOUR_DEPTH == 16)
     //fill 16bit colour
 	ssd1331_write_byte(hwColor >> 8, SSD1331_DATA);
+#endif
 	ssd1331_write_byte(hwColor, SSD1331_DATA);   
+#endif
 }
 
 void ssd1331_draw_line(uint8_t chXpos0, uint8_t chYpos0, uint8_t chXpos1, uint8_t chYpos1, uint16_t hwColor) 
 {
+	uint8_t chCmd[8] = { DRAW_LINE, chXpos0, chYpos0, chXpos1, chYpos1, __SSD1331_ACCEL_RGB(hwColor) };
+#if (SSD1331_FRAMEBUFFER == 1)
 	int x = chXpos1 - chXpos0;
     int y = chYpos1 - chYpos0;
     int dx = abs(x), sx = chXpos0 < chXpos1 ? 1 : -1;
     int dy = -abs(y), sy = chYpos0 < chYpos1 ? 1 : -1;
     int err = dx + dy, e2;
+#endif
 
 	if (chXpos0 >= OLED_WIDTH || chYpos0 >= OLED_HEIGHT || chXpos1 >= OLED_WIDTH || chYpos1 >= OLED_HEIGHT) {
 		return;
 	}
-    
+	ssd1331_accel_cmds(chCmd, sizeof(chCmd), SSD1331_ACCEL_LINE_MS);
+
+#if (SSD1331_FRAMEBUFFER == 1)
+	//the controller draws the line, only the framebuffers are updated here
     for (;;){
-        ssd1331_draw_point(chXpos0, chYpos0 , hwColor);
+        ssd1331_put_pixel_all(chXpos0, chYpos0 , hwColor);
         e2 = 2 * err;
         if (e2 >= dy) {     
             if (chXpos0 == chXpos1) break;
@@ -183,6 +642,7 @@ void ssd1331_draw_line(uint8_t chXpos0, uint8_t chYpos0, uint8_t chXpos1, uint8_
             err += dx; chYpos0 += sy;
         }
     }
+#endif
 }
 
 void ssd1331_draw_v_line(uint8_t chXpos, uint8_t chYpos, uint8_t chHeight, uint16_t hwColor)
@@ -192,9 +652,10 @@ void ssd1331_draw_v_line(uint8_t chXpos, uint8_t chYpos, uint8_t chHeight, uint1
 	if (chXpos >= OLED_WIDTH || chYpos >= OLED_HEIGHT) {
 		return;
 	}
+	ssd1331_mark_dirty(chXpos, chYpos, chXpos, y1 - 1);
 	
     for (i = chYpos; i < y1; i ++) {
-        ssd1331_draw_point(chXpos, i, hwColor);
+        ssd1331_put_pixel(chXpos, i, hwColor);
     }
 }
 
@@ -205,18 +666,62 @@ void ssd1331_draw_h_line(uint8_t chXpos, uint8_t chYpos, uint8_t chWidth, uint16
 	if (chXpos >= OLED_WIDTH || chYpos >= OLED_HEIGHT) {
 		return;
 	}
+	ssd1331_mark_dirty(chXpos, chYpos, x1 - 1, chYpos);
 	
     for (i = chXpos; i < x1; i ++) {
-        ssd1331_draw_point(i, chYpos, hwColor);
+        ssd1331_put_pixel(i, chYpos, hwColor);
     }
 }
 
+/**
+  * @brief  Fills a rectangle (inclusive, on screen) with the controller's DRAW_RECTANGLE
+  *         command, or CLEAR_WINDOW for black, and keeps the framebuffers in step
+**/
+static void ssd1331_accel_fill(uint8_t chX0, uint8_t chY0, uint8_t chX1, uint8_t chY1, uint16_t hwColor)
+{
+	if (0 == hwColor) {
+		uint8_t chCmd[5] = { CLEAR_WINDOW, chX0, chY0, chX1, chY1 };
+		ssd1331_accel_cmds(chCmd, sizeof(chCmd), SSD1331_ACCEL_FILL_MS);
+	} else {
+		uint8_t chCmd[13] = { FILL_WINDOW, ENABLE_FILL, DRAW_RECTANGLE, chX0, chY0, chX1, chY1,
+		                      __SSD1331_ACCEL_RGB(hwColor), __SSD1331_ACCEL_RGB(hwColor) };
+		ssd1331_accel_cmds(chCmd, sizeof(chCmd), SSD1331_ACCEL_FILL_MS);
+	}
+#if (SSD1331_FRAMEBUFFER == 1)
+	ssd1331_fill_all(chX0, chY0, chX1, chY1, hwColor);
+#endif
+}
+
 void ssd1331_draw_rect(uint8_t chXpos, uint8_t chYpos, uint8_t chWidth, uint8_t chHeight, uint16_t hwColor)
 {
 	if (chXpos >= OLED_WIDTH || chYpos >= OLED_HEIGHT) {
 		return;
 	}
 
+	//outline spans chXpos..chXpos+chWidth and chYpos..chYpos+chHeight; clipped ones are drawn in software
+	if (chXpos + chWidth < OLED_WIDTH && chYpos + chHeight < OLED_HEIGHT) {
+		uint8_t chX1 = chXpos + chWidth, chY1 = chYpos + chHeight;
+		uint8_t chCmd[13] = { FILL_WINDOW, DISABLE_FILL, DRAW_RECTANGLE, chXpos, chYpos, chX1, chY1,
+		                      __SSD1331_ACCEL_RGB(hwColor), __SSD1331_ACCEL_RGB(0) };
+
+		ssd1331_accel_cmds(chCmd, sizeof(chCmd), SSD1331_ACCEL_FILL_MS);
+#if (SSD1331_FRAMEBUFFER == 1)
+		{
+			uint8_t i;
+
+			for (i = chXpos; i <= chX1; i ++) {
+				ssd1331_put_pixel_all(i, chYpos, hwColor);
+				ssd1331_put_pixel_all(i, chY1, hwColor);
+			}
+			for (i = chYpos; i <= chY1; i ++) {
+				ssd1331_put_pixel_all(chXpos, i, hwColor);
+				ssd1331_put_pixel_all(chX1, i, hwColor);
+			}
+		}
+#endif
+		return;
+	}
+
 	ssd1331_draw_h_line(chXpos, chYpos, chWidth, hwColor);
 	ssd1331_draw_h_line(chXpos, chYpos + chHeight, chWidth, hwColor);
 	ssd1331_draw_v_line(chXpos, chYpos, chHeight, hwColor);
@@ -225,17 +730,87 @@ void ssd1331_draw_rect(uint8_t chXpos, uint8_t chYpos, uint8_t chWidth, uint8_t
 
 void ssd1331_fill_rect(uint8_t chXpos, uint8_t chYpos, uint8_t chWidth, uint8_t chHeight, uint16_t hwColor)
 {
-	uint16_t i, j;
+	uint8_t chX1, chY1;
 
-	if (chXpos >= OLED_WIDTH || chYpos >= OLED_HEIGHT) {
+	if (chXpos >= OLED_WIDTH || chYpos >= OLED_HEIGHT || 0 == chWidth || 0 == chHeight) {
 		return;
 	}
-	
-	for(i = 0; i < chHeight; i ++){
-		for(j = 0; j < chWidth; j ++){
-			ssd1331_draw_point(chXpos + j, chYpos + i, hwColor);
+	chX1 = MIN(chXpos + chWidth - 1, OLED_WIDTH - 1);
+	chY1 = MIN(chYpos + chHeight - 1, OLED_HEIGHT - 1);
+
+#if (SSD1331_FRAMEBUFFER == 1)
+	if ((chX1 - chXpos + 1) * (chY1 - chYpos + 1) < SSD1331_ACCEL_MIN_AREA) {
+		uint16_t i, j;
+
+		ssd1331_mark_dirty(chXpos, chYpos, chX1, chY1);
+		for(i = chYpos; i <= chY1; i ++){
+			for(j = chXpos; j <= chX1; j ++){
+				ssd1331_put_pixel(j, i, hwColor);
+			}
+		}
+		return;
+	}
+#endif
+	ssd1331_accel_fill(chXpos, chYpos, chX1, chY1, hwColor);
+}
+
+#if (SSD1331_FRAMEBUFFER == 1)
+/**
+  * @brief  Moves a rectangle of one framebuffer, rows in the order that keeps overlapping
+  *         source rows intact
+**/
+static void ssd1331_fb_move(ssd1331_pixel_t (*phwBuf)[OLED_WIDTH], uint8_t chX0, uint8_t chY0, uint8_t chX1, uint8_t chY1,
+                            uint8_t chXdst, uint8_t chYdst)
+{
+	uint8_t chRows = chY1 - chY0 + 1, i, chRow;
+	size_t tBytes = (size_t)(chX1 - chX0 + 1) * SSD1331_BPP;
+
+	for (i = 0; i < chRows; i ++) {
+		chRow = (chYdst > chY0) ? (chRows - 1 - i) : i;
+		memmove(&phwBuf[chYdst + chRow][chXdst], &phwBuf[chY0 + chRow][chX0], tBytes);
+	}
+}
+#endif
+
+/**
+  * @brief  Copies a rectangle of the display to another position with the controller's
+  *         COPY_WINDOW command, e.g. to scroll part of the screen by a column
+  * @param  chX0, chY0, chX1, chY1: source rectangle, inclusive
+  * @param  chXdst, chYdst: top left corner of the destination
+  * @retval None
+**/
+void ssd1331_copy_window(uint8_t chX0, uint8_t chY0, uint8_t chX1, uint8_t chY1, uint8_t chXdst, uint8_t chYdst)
+{
+	uint8_t chCmd[7] = { COPY_WINDOW, chX0, chY0, chX1, chY1, chXdst, chYdst };
+
+	if (chX0 > chX1 || chY0 > chY1 || chX1 >= OLED_WIDTH || chY1 >= OLED_HEIGHT ||
+	    chXdst + (chX1 - chX0) >= OLED_WIDTH || chYdst + (chY1 - chY0) >= OLED_HEIGHT) {
+		return;
+	}
+
+#if (SSD1331_FRAMEBUFFER == 1)
+	{
+		uint8_t i;
+		ssd1331_rect_t *ptRect;
+
+		//pixels not flushed yet in the source are not on the display to be copied there, so move them in RAM
+		for (i = 0; i < s_chDirtyCount; i ++) {
+			ptRect = &s_tDirty[i];
+			if (ptRect->chX0 <= chX1 && ptRect->chX1 >= chX0 && ptRect->chY0 <= chY1 && ptRect->chY1 >= chY0) {
+				ssd1331_fb_move(s_phwDraw, chX0, chY0, chX1, chY1, chXdst, chYdst);
+				ssd1331_mark_dirty(chXdst, chYdst, chXdst + (chX1 - chX0), chYdst + (chY1 - chY0));
+				return;
+			}
+		}
+
+		ssd1331_accel_cmds(chCmd, sizeof(chCmd), SSD1331_ACCEL_FILL_MS);
+		for (i = 0; i < SSD1331_FB_COUNT; i ++) {
+			ssd1331_fb_move(s_hwFrameBuffer[i], chX0, chY0, chX1, chY1, chXdst, chYdst);
 		}
 	}
+#else
+	ssd1331_accel_cmds(chCmd, sizeof(chCmd), SSD1331_ACCEL_FILL_MS);
+#endif
 }
 
 void ssd1331_draw_circle(uint8_t chXpos, uint8_t chYpos, uint8_t chRadius, uint16_t hwColor)
@@ -245,12 +820,13 @@ void ssd1331_draw_circle(uint8_t chXpos, uint8_t chYpos, uint8_t chRadius, uint1
 	if (chXpos >= OLED_WIDTH || chYpos >= OLED_HEIGHT) {
 		return;
 	}
+	ssd1331_mark_dirty(chXpos - chRadius, chYpos - chRadius, chXpos + chRadius, chYpos + chRadius);
 	
     do {
-        ssd1331_draw_point(chXpos - x, chYpos + y, hwColor);
-        ssd1331_draw_point(chXpos + x, chYpos + y, hwColor);
-        ssd1331_draw_point(chXpos + x, chYpos - y, hwColor);
-        ssd1331_draw_point(chXpos - x, chYpos - y, hwColor);
+        ssd1331_put_pixel(chXpos - x, chYpos + y, hwColor);
+        ssd1331_put_pixel(chXpos + x, chYpos + y, hwColor);
+        ssd1331_put_pixel(chXpos + x, chYpos - y, hwColor);
+        ssd1331_put_pixel(chXpos - x, chYpos - y, hwColor);
         e2 = err;
         if (e2 <= y) {
             err += ++ y * 2 + 1;
@@ -260,47 +836,112 @@ void ssd1331_draw_circle(uint8_t chXpos, uint8_t chYpos, uint8_t chRadius, uint1
     } while(x <= 0);
 }
 
+/**
+  * @brief  Expands one glyph row into pixels: the row is cleared to black once and each run of
+  *         set bits is filled in, the runs found with CLZ rather than bit by bit
+  * @param  ptDst: first pixel of the row
+  * @param  hwBits: row from font_glyph_row(), bit 15 is the leftmost column
+  * @param  chWidth: pixels to write (at most 16), set bits beyond it are dropped
+  * @param  tFore: foreground pixel in bus order
+  * @retval None
+**/
+void ssd1331_expand_glyph_row(ssd1331_pixel_t *ptDst, uint16_t hwBits, uint8_t chWidth, ssd1331_pixel_t tFore)
+{
+	uint32_t wBits = ((uint32_t)hwBits << 16) & ~(0xFFFFFFFFu >> chWidth);
+	uint8_t chStart, chEnd;
+
+	memset(ptDst, 0, (size_t)chWidth * SSD1331_BPP);
+	while (wBits) {
+		chStart = __CLZ(wBits);
+		chEnd = chStart + __CLZ(~(wBits << chStart));
+		while (chStart < chEnd) {
+			ptDst[chStart ++] = tFore;
+		}
+		wBits &= 0xFFFFFFFFu >> chEnd;
+	}
+}
+
+/**
+  * @brief  Returns the expanded pixels of a character, from the cache or by expanding the
+  *         font bitmap into the least recently used entry
+  * @param  chChr: character, 0x20..0x7E
+  * @param  chSize: FONT_1206 or FONT_1608
+  * @param  hwColor: foreground colour, the background is black
+  * @retval Glyph of chSize / 2 x chSize pixels
+**/
+static const ssd1331_glyph_t *ssd1331_get_glyph(uint8_t chChr, uint8_t chSize, uint16_t hwColor)
+{
+	uint8_t i, chRow;
+	ssd1331_glyph_t *ptGlyph = &s_tGlyphCache[0];
+	const font_packed_t *ptFont;
+	ssd1331_pixel_t tFore = __SSD1331_PIXEL(hwColor);
+
+	s_wGlyphClock ++;
+	for (i = 0; i < SSD1331_GLYPH_CACHE; i ++) {
+		if (s_tGlyphCache[i].chSize == chSize && s_tGlyphCache[i].chChr == chChr && s_tGlyphCache[i].hwColor == hwColor) {
+			s_tGlyphCache[i].wLastUse = s_wGlyphClock;
+			return &s_tGlyphCache[i];
+		}
+		if (s_tGlyphCache[i].wLastUse < ptGlyph->wLastUse) {
+			ptGlyph = &s_tGlyphCache[i];
+		}
+	}
+
+	//miss: the packed font gives one row mask at a time, expanded by runs
+	ptGlyph->chChr = chChr;
+	ptGlyph->chSize = chSize;
+	ptGlyph->hwColor = hwColor;
+	ptGlyph->wLastUse = s_wGlyphClock;
+	ptFont = (FONT_1206 == chSize) ? &c_tFont1206 : &c_tFont1608;
+	for (chRow = 0; chRow < chSize; chRow ++) {
+		ssd1331_expand_glyph_row(&ptGlyph->hwPixels[chRow * (chSize / 2)], font_glyph_row(ptFont, chChr, chRow), chSize / 2, tFore);
+	}
+	return ptGlyph;
+}
+
 /**
   * @brief Displays one character at the specified position    
   *         
   * @param  chXpos: Specifies the X position
   * @param  chYpos: Specifies the Y position
-  * @param  chSize: 
-  * @param  chMode
-  * @retval 
+  * @param  chSize: FONT_1206 or FONT_1608
+  * @param  hwColor: foreground colour, the background is black
+  * @retval None
 **/
 void ssd1331_display_char(uint8_t chXpos, uint8_t chYpos, uint8_t chChr, uint8_t chSize, uint16_t hwColor)
 {      	
-	uint8_t i, j, chTemp;
-	uint8_t chYpos0 = chYpos;
+	const ssd1331_glyph_t *ptGlyph;
+	uint8_t chRow, chWidth = chSize / 2, chX1, chY1;
 
-	chTemp = 0;
 	if (chXpos >= OLED_WIDTH || chYpos >= OLED_HEIGHT) {
 		return;
 	}
-					   
-    for (i = 0; i < chSize; i ++) {   
-		if (FONT_1206 == chSize) {
-			chTemp = c_chFont1206[chChr - 0x20][i];  
-		} else if (FONT_1608 == chSize) { 
-			chTemp = c_chFont1608[chChr - 0x20][i];
+	if ((FONT_1206 != chSize && FONT_1608 != chSize) || chChr < 0x20 || chChr > 0x7E) {
+		return;
+	}
+	ptGlyph = ssd1331_get_glyph(chChr, chSize, hwColor);
+	chX1 = MIN(chXpos + chWidth - 1, OLED_WIDTH - 1);
+	chY1 = MIN(chYpos + chSize - 1, OLED_HEIGHT - 1);
+
+#if (SSD1331_FRAMEBUFFER == 1)
+	ssd1331_mark_dirty(chXpos, chYpos, chX1, chY1);
+	for (chRow = 0; chRow <= chY1 - chYpos; chRow ++) {
+		memcpy(&s_phwDraw[chYpos + chRow][chXpos], &ptGlyph->hwPixels[chRow * chWidth], (size_t)(chX1 - chXpos + 1) * SSD1331_BPP);
+	}
+#else
+	//one window per character, the expanded rows are streamed with a single chip select
+	ssd1331_set_window(chXpos, chYpos, chX1, chY1);
+	__SSD1331_DC_SET();
+	__SSD1331_CS_CLR();
+	if (chX1 - chXpos + 1 == chWidth) {
+		__SSD1331_WRITE_BUF(ptGlyph->hwPixels, (uint16_t)(chY1 - chYpos + 1) * chWidth * SSD1331_BPP);
+	} else {
+		for (chRow = 0; chRow <= chY1 - chYpos; chRow ++) {
+			__SSD1331_WRITE_BUF(&ptGlyph->hwPixels[chRow * chWidth], (uint16_t)(chX1 - chXpos + 1) * SSD1331_BPP);
 		}
-		
-        for (j = 0; j < 8; j ++) {
-    		if (chTemp & 0x80) {
-		  ssd1331_draw_point(chXpos, chYpos, hwColor);
-    		} else {
-		  ssd1331_draw_point(chXpos, chYpos, 0);
-		}		  
-			chTemp <<= 1;
-			chYpos ++;
-			if ((chYpos - chYpos0) == chSize) {
-				chYpos = chYpos0;
-				chXpos ++;
-				break;
-			}
-		}  	 
-    } 
+	}
+	__SSD1331_CS_SET();
+#endif
 }
 
 static uint32_t _pow(uint8_t m, uint8_t n)
@@ -367,58 +1008,47 @@ void ssd1331_display_string(uint8_t chXpos, uint8_t chYpos, const char *pchStrin
     } 
 }
 
-void ssd1331_draw_1616char(uint8_t chXpos, uint8_t chYpos, uint8_t chChar, uint16_t hwColor)
+/**
+  * @brief  Draws the set pixels of a packed glyph, a run at a time; the background is left as it is
+**/
+static void ssd1331_draw_packed_char(uint8_t chXpos, uint8_t chYpos, const font_packed_t *ptFont, uint8_t chChr, uint16_t hwColor)
 {
-	uint8_t i, j;
-	uint8_t chTemp = 0, chYpos0 = chYpos;
-
-	for (i = 0; i < 32; i ++) {
-		chTemp = c_chFont1612[chChar - 0x30][i];
-		for (j = 0; j < 8; j ++) {
-			if (chTemp & 0x80) {
-				ssd1331_draw_point(chXpos, chYpos, hwColor);
-    		}
-			chTemp <<= 1;
-			chYpos ++;
-			if ((chYpos - chYpos0) == 16) {
-				chYpos = chYpos0;
-				chXpos ++;
-				break;
+	uint8_t chRow, chStart, chEnd;
+	uint32_t wBits;
+
+	ssd1331_mark_dirty(chXpos, chYpos, chXpos + ptFont->chWidth - 1, chYpos + ptFont->chHeight - 1);
+	for (chRow = 0; chRow < ptFont->chHeight; chRow ++) {
+		wBits = (uint32_t)font_glyph_row(ptFont, chChr, chRow) << 16;
+		while (wBits) {
+			chStart = __CLZ(wBits);
+			chEnd = chStart + __CLZ(~(wBits << chStart));
+			for (; chStart < chEnd; chStart ++) {
+				ssd1331_put_pixel(chXpos + chStart, chYpos + chRow, hwColor);
 			}
+			wBits &= 0xFFFFFFFFu >> chEnd;
 		}
 	}
 }
 
+void ssd1331_draw_1616char(uint8_t chXpos, uint8_t chYpos, uint8_t chChar, uint16_t hwColor)
+{
+	ssd1331_draw_packed_char(chXpos, chYpos, &c_tFont1612, chChar, hwColor);
+}
+
 void ssd1331_draw_3216char(uint8_t chXpos, uint8_t chYpos, uint8_t chChar, uint16_t hwColor)
 {
-	uint8_t i, j;
-	uint8_t chTemp = 0, chYpos0 = chYpos;
-
-	for (i = 0; i < 64; i ++) {
-		chTemp = c_chFont3216[chChar - 0x30][i];
-		for (j = 0; j < 8; j ++) {
-			if (chTemp & 0x80) {
-				ssd1331_draw_point(chXpos, chYpos, hwColor);
-    		}
-			chTemp <<= 1;
-			chYpos ++;
-			if ((chYpos - chYpos0) == 32) {
-				chYpos = chYpos0;
-				chXpos ++;
-				break;
-			}
-		}
-	}
+	ssd1331_draw_packed_char(chXpos, chYpos, &c_tFont3216, chChar, hwColor);
 }
 
 void ssd1331_draw_bitmap(uint8_t chXpos, uint8_t chYpos, const uint8_t *pchBmp, uint8_t chWidth, uint8_t chHeight, uint16_t hwColor)
 {
 	uint16_t i, j, byteWidth = (chWidth + 7) / 8;
 	
+	ssd1331_mark_dirty(chXpos, chYpos, chXpos + chWidth - 1, chYpos + chHeight - 1);
     for(j = 0; j < chHeight; j ++){
         for(i = 0; i < chWidth; i ++ ) {
             if(*(pchBmp + j * byteWidth + i / 8) & (128 >> (i & 7))) {
-                ssd1331_draw_point(chXpos + i, chYpos + j, hwColor);
+                ssd1331_put_pixel(chXpos + i, chYpos + j, hwColor);
             }
         }
     }
@@ -426,13 +1056,7 @@ void ssd1331_draw_bitmap(uint8_t chXpos, uint8_t chYpos, const uint8_t *pchBmp,
 
 void ssd1331_clear_screen(uint16_t hwColor)  
 {
-	uint16_t i, j;
-	
-	for(i = 0; i < OLED_HEIGHT; i ++){
-		for(j = 0; j < OLED_WIDTH; j ++){
-			ssd1331_draw_point(j, i, hwColor);
-		}
-	}
+	ssd1331_accel_fill(0, 0, OLED_WIDTH - 1, OLED_HEIGHT - 1, hwColor);
 }
 
 
@@ -457,7 +1081,7 @@ void ssd1331_init(void)
   ssd1331_write_byte(SET_PRECHARGE_SPEED_C, SSD1331_CMD);//Set Second Pre-change Speed For ColorC
   ssd1331_write_byte(0x64, SSD1331_CMD);                     //100
   ssd1331_write_byte(SET_REMAP, SSD1331_CMD);            //set remap & data format
-  ssd1331_write_byte(0x72, SSD1331_CMD);                     //0x72              
+  ssd1331_write_byte(SSD1331_REMAP_FORMAT, SSD1331_CMD);     //0x72, 0x32 in 256 colour mode              
   ssd1331_write_byte(SET_DISPLAY_START_LINE, SSD1331_CMD);//Set display Start Line
   ssd1331_write_byte(0x0, SSD1331_CMD);
   ssd1331_write_byte(SET_DISPLAY_OFFSET, SSD1331_CMD);   //Set display offset
@@ -482,6 +1106,7 @@ void ssd1331_init(void)
   
   //ssd1331_fill_rect(0, 0, 96, 64, 0x0000);
   ssd1331_clear_screen(0x0000);
+  ssd1331_flush();
 }
 
 
@@ -0,0 +1,353 @@
+/**
+  ******************************************************************************
+  * @file    ssd1331_band.c
+  * @brief   Band renderer for the SSD1331
+  *
+  *          Instead of keeping the screen in a framebuffer, the application
+  *          describes it with a short display list (rectangles, lines, text and
+  *          plots). ssd1331_band_render() rasterises the list SSD1331_BAND_ROWS
+  *          rows at a time into one band buffer and streams each band with one
+  *          window command. A hash of every band sent is kept, so bands that
+  *          rasterise to the same pixels as last time are not sent again.
+  *
+  *          RAM: one band (1536 bytes in 16-bit colour, 768 in 8-bit), the
+  *          display list and one hash per band, instead of a 12 KB framebuffer.
+  *          Build with SSD1331_FRAMEBUFFER 0 to get the saving.
+  ******************************************************************************
+  */
+
+#include <string.h>
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "ssd1331_band.h"
+#include "fonts.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef enum {
+	BAND_CMD_FILL_RECT = 0,
+	BAND_CMD_LINE,
+	BAND_CMD_TEXT,
+	BAND_CMD_PLOT
+} band_cmd_type_t;
+
+typedef struct {
+	uint8_t chType;                     /* band_cmd_type_t */
+	uint8_t chX0, chY0, chX1, chY1;     /* bounding box, inclusive; line end points */
+	uint8_t chSize;                     /* text: font size */
+	uint16_t hwColor;
+	union {
+		char chText[SSD1331_BAND_TEXT_LEN];
+		struct {
+			const uint8_t *pchRows;     /* plot: row of each sample, 0xFF for none */
+			const uint16_t *phwColors;  /* plot: colour of each sample */
+			uint8_t chCount;            /* plot: ring buffer length = number of columns */
+			uint8_t chFirst;            /* plot: ring buffer index of the leftmost column */
+		} tPlot;
+	} u;
+} band_cmd_t;
+
+/* Private define ------------------------------------------------------------*/
+#define SSD1331_BANDS           (OLED_HEIGHT / SSD1331_BAND_ROWS)
+#define BAND_NO_SAMPLE          0xFF
+
+#if (OLED_HEIGHT % SSD1331_BAND_ROWS) != 0
+#error "SSD1331_BAND_ROWS must divide OLED_HEIGHT"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static ssd1331_pixel_t s_tBand[SSD1331_BAND_ROWS][OLED_WIDTH];
+static band_cmd_t s_tCmds[SSD1331_BAND_MAX_CMDS];
+static uint8_t s_chCmdCount = 0;
+static ssd1331_pixel_t s_tBackground = 0;
+static uint32_t s_wBandHash[SSD1331_BANDS];
+static uint8_t s_chHashValid = 0;
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Returns a new display list entry, NULL when the list is full
+**/
+static band_cmd_t *ssd1331_band_new(uint8_t chType, uint8_t chX0, uint8_t chY0, uint8_t chX1, uint8_t chY1, uint16_t hwColor)
+{
+	band_cmd_t *ptCmd;
+
+	if (s_chCmdCount >= SSD1331_BAND_MAX_CMDS || chX0 >= OLED_WIDTH || chY0 >= OLED_HEIGHT) {
+		return NULL;
+	}
+	ptCmd = &s_tCmds[s_chCmdCount ++];
+	ptCmd->chType = chType;
+	ptCmd->chX0 = chX0;
+	ptCmd->chY0 = chY0;
+	ptCmd->chX1 = (chX1 < OLED_WIDTH) ? chX1 : OLED_WIDTH - 1;
+	ptCmd->chY1 = (chY1 < OLED_HEIGHT) ? chY1 : OLED_HEIGHT - 1;
+	ptCmd->hwColor = hwColor;
+	return ptCmd;
+}
+
+static inline void ssd1331_band_pixel(uint8_t chBandY, uint8_t chXpos, uint8_t chYpos, ssd1331_pixel_t tPixel)
+{
+	if (chXpos < OLED_WIDTH && chYpos >= chBandY && chYpos < chBandY + SSD1331_BAND_ROWS) {
+		s_tBand[chYpos - chBandY][chXpos] = tPixel;
+	}
+}
+
+static void ssd1331_band_raster_line(const band_cmd_t *ptCmd, uint8_t chBandY)
+{
+	int x0 = ptCmd->chX0, y0 = ptCmd->chY0, x1 = ptCmd->chX1, y1 = ptCmd->chY1;
+	int dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+	int dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+	int err = dx + dy, e2;
+	ssd1331_pixel_t tPixel = __SSD1331_PIXEL(ptCmd->hwColor);
+
+	for (;;) {
+		ssd1331_band_pixel(chBandY, x0, y0, tPixel);
+		e2 = 2 * err;
+		if (e2 >= dy) {
+			if (x0 == x1) break;
+			err += dy; x0 += sx;
+		}
+		if (e2 <= dx) {
+			if (y0 == y1) break;
+			err += dx; y0 += sy;
+		}
+	}
+}
+
+/**
+  * @brief  Text cells are opaque (black background) like ssd1331_display_char(); each glyph
+  *         row is fetched from the packed font and expanded by runs
+**/
+static void ssd1331_band_raster_text(const band_cmd_t *ptCmd, uint8_t chBandY)
+{
+	uint8_t chWidth = ptCmd->chSize / 2;
+	uint8_t chY0 = (ptCmd->chY0 > chBandY) ? ptCmd->chY0 : chBandY;
+	uint8_t chY1 = (ptCmd->chY1 < chBandY + SSD1331_BAND_ROWS - 1) ? ptCmd->chY1 : chBandY + SSD1331_BAND_ROWS - 1;
+	ssd1331_pixel_t tFore = __SSD1331_PIXEL(ptCmd->hwColor);
+	const font_packed_t *ptFont = (FONT_1206 == ptCmd->chSize) ? &c_tFont1206 : &c_tFont1608;
+	uint8_t i, chX, chCols, chY;
+	char chChr;
+
+	for (i = 0; i < SSD1331_BAND_TEXT_LEN && ptCmd->u.chText[i] != '\0'; i ++) {
+		chChr = ptCmd->u.chText[i];
+		if (chChr < 0x20 || chChr > 0x7E) {
+			continue;
+		}
+		chX = ptCmd->chX0 + i * chWidth;
+		if (chX > ptCmd->chX1) {
+			return;
+		}
+		chCols = (ptCmd->chX1 - chX + 1 < chWidth) ? ptCmd->chX1 - chX + 1 : chWidth;
+		for (chY = chY0; chY <= chY1; chY ++) {
+			ssd1331_expand_glyph_row(&s_tBand[chY - chBandY][chX], font_glyph_row(ptFont, chChr, chY - ptCmd->chY0), chCols, tFore);
+		}
+	}
+}
+
+/**
+  * @brief  One column per sample, joined to the previous sample by a vertical segment
+**/
+static void ssd1331_band_raster_plot(const band_cmd_t *ptCmd, uint8_t chBandY)
+{
+	uint8_t i, chRow, chPrev = BAND_NO_SAMPLE, chTop, chBottom, chY;
+	uint8_t chIndex = ptCmd->u.tPlot.chFirst;
+
+	for (i = 0; i < ptCmd->u.tPlot.chCount && ptCmd->chX0 + i <= ptCmd->chX1; i ++) {
+		chRow = ptCmd->u.tPlot.pchRows[chIndex];
+		if (chRow != BAND_NO_SAMPLE) {
+			chTop = chBottom = chRow;
+			if (chPrev != BAND_NO_SAMPLE) {
+				chTop = (chPrev < chRow) ? chPrev : chRow;
+				chBottom = (chPrev > chRow) ? chPrev : chRow;
+			}
+			for (chY = chTop; chY <= chBottom; chY ++) {
+				ssd1331_band_pixel(chBandY, ptCmd->chX0 + i, chY, __SSD1331_PIXEL(ptCmd->u.tPlot.phwColors[chIndex]));
+			}
+		}
+		chPrev = chRow;
+		if (++ chIndex == ptCmd->u.tPlot.chCount) {
+			chIndex = 0;
+		}
+	}
+}
+
+/**
+  * @brief  FNV-1a hash of the band buffer
+**/
+static uint32_t ssd1331_band_hash(void)
+{
+	const uint8_t *pchData = (const uint8_t *)s_tBand;
+	uint32_t wHash = 2166136261UL;
+	uint16_t i;
+
+	for (i = 0; i < sizeof(s_tBand); i ++) {
+		wHash = (wHash ^ pchData[i]) * 16777619UL;
+	}
+	return wHash;
+}
+
+/**
+  * @brief  Empties the display list
+  * @param  hwBackground: colour of the pixels no entry covers
+  * @retval None
+**/
+void ssd1331_band_clear(uint16_t hwBackground)
+{
+	s_chCmdCount = 0;
+	s_tBackground = __SSD1331_PIXEL(hwBackground);
+}
+
+/**
+  * @brief  Adds a filled rectangle to the display list
+  * @retval 0 when added, 1 when the display list is full or the position is off screen
+**/
+uint8_t ssd1331_band_fill_rect(uint8_t chXpos, uint8_t chYpos, uint8_t chWidth, uint8_t chHeight, uint16_t hwColor)
+{
+	if (0 == chWidth || 0 == chHeight) {
+		return 0;
+	}
+	return (NULL == ssd1331_band_new(BAND_CMD_FILL_RECT, chXpos, chYpos, chXpos + chWidth - 1, chYpos + chHeight - 1, hwColor));
+}
+
+/**
+  * @brief  Adds a line to the display list; both end points must be on screen
+  * @retval 0 when added, 1 otherwise
+**/
+uint8_t ssd1331_band_line(uint8_t chXpos0, uint8_t chYpos0, uint8_t chXpos1, uint8_t chYpos1, uint16_t hwColor)
+{
+	band_cmd_t *ptCmd;
+
+	if (chXpos1 >= OLED_WIDTH || chYpos1 >= OLED_HEIGHT) {
+		return 1;
+	}
+	ptCmd = ssd1331_band_new(BAND_CMD_LINE, chXpos0, chYpos0, chXpos1, chYpos1, hwColor);
+	return (NULL == ptCmd);
+}
+
+/**
+  * @brief  Adds a string (copied, at most SSD1331_BAND_TEXT_LEN characters) to the display list
+  * @param  chSize: FONT_1206 or FONT_1608
+  * @retval 0 when added, 1 otherwise
+**/
+uint8_t ssd1331_band_text(uint8_t chXpos, uint8_t chYpos, const char *pchString, uint8_t chSize, uint16_t hwColor)
+{
+	band_cmd_t *ptCmd;
+	uint8_t chLen = strnlen(pchString, SSD1331_BAND_TEXT_LEN);
+
+	if ((FONT_1206 != chSize && FONT_1608 != chSize) || 0 == chLen) {
+		return 1;
+	}
+	ptCmd = ssd1331_band_new(BAND_CMD_TEXT, chXpos, chYpos, chXpos + chLen * (chSize / 2) - 1, chYpos + chSize - 1, hwColor);
+	if (NULL == ptCmd) {
+		return 1;
+	}
+	ptCmd->chSize = chSize;
+	memset(ptCmd->u.chText, 0, SSD1331_BAND_TEXT_LEN);
+	memcpy(ptCmd->u.chText, pchString, chLen);
+	return 0;
+}
+
+/**
+  * @brief  Adds a strip chart to the display list. The samples are not copied: the ring
+  *         buffers must stay valid until the list is cleared.
+  * @param  chXpos, chYpos, chHeight: position of the leftmost column and height of the chart
+  * @param  pchRows: display row of each sample, 0xFF for a gap
+  * @param  phwColors: colour of each sample
+  * @param  chCount: length of the ring buffers, one column per sample
+  * @param  chFirst: index of the oldest sample, drawn in the leftmost column
+  * @retval 0 when added, 1 otherwise
+**/
+uint8_t ssd1331_band_plot(uint8_t chXpos, uint8_t chYpos, uint8_t chHeight, const uint8_t *pchRows,
+                          const uint16_t *phwColors, uint8_t chCount, uint8_t chFirst)
+{
+	band_cmd_t *ptCmd;
+
+	if (0 == chCount || 0 == chHeight) {
+		return 1;
+	}
+	ptCmd = ssd1331_band_new(BAND_CMD_PLOT, chXpos, chYpos, chXpos + chCount - 1, chYpos + chHeight - 1, 0);
+	if (NULL == ptCmd) {
+		return 1;
+	}
+	ptCmd->u.tPlot.pchRows = pchRows;
+	ptCmd->u.tPlot.phwColors = phwColors;
+	ptCmd->u.tPlot.chCount = chCount;
+	ptCmd->u.tPlot.chFirst = chFirst;
+	return 0;
+}
+
+/**
+  * @brief  Makes the next ssd1331_band_render() send every band (e.g. after the display was
+  *         drawn on directly)
+**/
+void ssd1331_band_invalidate(void)
+{
+	s_chHashValid = 0;
+}
+
+/**
+  * @brief  Rasterises the display list band by band, in list order, and sends each band
+  *         that differs from what was sent for it last time
+  * @retval None
+**/
+void ssd1331_band_render(void)
+{
+	uint8_t chBand, chBandY, i, x, y, y0, y1;
+	uint32_t wHash;
+	band_cmd_t *ptCmd;
+
+	for (chBand = 0; chBand < SSD1331_BANDS; chBand ++) {
+		chBandY = chBand * SSD1331_BAND_ROWS;
+
+		for (y = 0; y < SSD1331_BAND_ROWS; y ++) {
+			for (x = 0; x < OLED_WIDTH; x ++) {
+				s_tBand[y][x] = s_tBackground;
+			}
+		}
+
+		for (i = 0; i < s_chCmdCount; i ++) {
+			ptCmd = &s_tCmds[i];
+			//skip entries whose bounding box misses this band; line end points are not a box, see below
+			if (ptCmd->chType != BAND_CMD_LINE &&
+			    (ptCmd->chY1 < chBandY || ptCmd->chY0 >= chBandY + SSD1331_BAND_ROWS)) {
+				continue;
+			}
+			switch (ptCmd->chType) {
+			case BAND_CMD_FILL_RECT:
+				y0 = (ptCmd->chY0 > chBandY) ? ptCmd->chY0 : chBandY;
+				y1 = (ptCmd->chY1 < chBandY + SSD1331_BAND_ROWS - 1) ? ptCmd->chY1 : chBandY + SSD1331_BAND_ROWS - 1;
+				for (y = y0; y <= y1; y ++) {
+					for (x = ptCmd->chX0; x <= ptCmd->chX1; x ++) {
+						s_tBand[y - chBandY][x] = __SSD1331_PIXEL(ptCmd->hwColor);
+					}
+				}
+				break;
+			case BAND_CMD_LINE:
+				if ((ptCmd->chY0 < chBandY && ptCmd->chY1 < chBandY) ||
+				    (ptCmd->chY0 >= chBandY + SSD1331_BAND_ROWS && ptCmd->chY1 >= chBandY + SSD1331_BAND_ROWS)) {
+					break;
+				}
+				ssd1331_band_raster_line(ptCmd, chBandY);
+				break;
+			case BAND_CMD_TEXT:
+				ssd1331_band_raster_text(ptCmd, chBandY);
+				break;
+			case BAND_CMD_PLOT:
+				ssd1331_band_raster_plot(ptCmd, chBandY);
+				break;
+			default:
+				break;
+			}
+		}
+
+		wHash = ssd1331_band_hash();
+		if (s_chHashValid && wHash == s_wBandHash[chBand]) {
+			continue;
+		}
+		s_wBandHash[chBand] = wHash;
+		ssd1331_write_window(0, chBandY, OLED_WIDTH - 1, chBandY + SSD1331_BAND_ROWS - 1, s_tBand, sizeof(s_tBand));
+	}
+	s_chHashValid = 1;
+}
+
+/*-------------------------------END OF FILE-------------------------------*/
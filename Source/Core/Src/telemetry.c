@@ -0,0 +1,177 @@
+/*******************************************************************************
+  * File Name          : telemetry.c
+  * Description        :
+  *    Streams one compact binary record per ranging exchange over USART2,
+  *    COBS framed and CRC protected. See telemetry.h for the record layout.
+  *
+  *    A frame is 30 bytes, which takes 0.33 ms at 921600 baud. It is queued
+  *    with port_tx_msg() like printf output, so sending never blocks and a
+  *    frame is never interleaved with other output.
+  ******************************************************************************
+  */
+#include "telemetry.h"
+#include "main.h"
+#include <port.h>
+#include <string.h>
+
+// Private defines
+#define RECORD_LENGTH 26
+#define CRC_LENGTH    2
+
+// Private global variables
+static uint16_t sequence = 0;
+static uint32_t reportedDrops = 0;
+
+// CRC-16/CCITT of each value of a nibble
+static const uint16_t crcNibbleTable[16] =
+{
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+  0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+// FUNCTION      : computeTelemetryCrc
+// DESCRIPTION   :
+//    Computes the CRC-16/CCITT (poly 0x1021, init 0xFFFF) of a buffer, one
+//    nibble at a time.
+// PARAMETERS    :
+//    const uint8_t* data : Data.
+//    uint16_t length     : Length of the data.
+// RETURNS       :
+//    uint16_t : CRC.
+uint16_t computeTelemetryCrc(const uint8_t* data, uint16_t length)
+{
+  uint16_t crc = 0xFFFF;
+
+  while (length--)
+  {
+    crc = (crc << 4) ^ crcNibbleTable[(crc >> 12) ^ (*data >> 4)];
+    crc = (crc << 4) ^ crcNibbleTable[(crc >> 12) ^ (*data & 0x0F)];
+    data++;
+  }
+
+  return crc;
+}
+
+// FUNCTION      : encodeTelemetryCobs
+// DESCRIPTION   :
+//    Encodes a buffer of any length with Consistent Overhead Byte Stuffing,
+//    so the output has no zero bytes. The output is length / 254 + 1 bytes
+//    longer and may overlap the input when it starts at least that many
+//    bytes before it, so a long frame can be encoded in place.
+// PARAMETERS    :
+//    uint8_t* dst       : Encoded data.
+//    const uint8_t* src : Data.
+//    uint16_t length    : Length of the data.
+// RETURNS       :
+//    uint16_t : Length of the encoded data.
+uint16_t encodeTelemetryCobs(uint8_t* dst, const uint8_t* src, uint16_t length)
+{
+  uint8_t* const start = dst;
+  uint8_t* code = dst++; // Distance to the next zero, written once it is known
+  uint8_t run = 1;
+  uint16_t i;
+
+  for (i = 0; i < length; i++)
+  {
+    if (src[i] == 0)
+    {
+      *code = run;
+      code = dst++;
+      run = 1;
+    }
+    else
+    {
+      *dst++ = src[i];
+      if (++run == 0xFF)
+      {
+        // 254 bytes without a zero: start a new block
+        *code = run;
+        code = dst++;
+        run = 1;
+      }
+    }
+  }
+  *code = run;
+
+  return dst - start;
+}
+
+// FUNCTION      : buildTelemetryFrame
+// DESCRIPTION   :
+//    Appends the CRC to a payload and COBS encodes it between two delimiters.
+// PARAMETERS    :
+//    uint8_t* payload : Payload, the first byte tells the frame type. Needs
+//                       room for the 2 CRC bytes after the payload.
+//    uint8_t length   : Length of the payload, TELEMETRY_MAX_FRAME_PAYLOAD at most.
+//    uint8_t* frame   : Frame, length + TELEMETRY_FRAME_OVERHEAD bytes.
+// RETURNS       :
+//    uint8_t : Length of the frame.
+uint8_t buildTelemetryFrame(uint8_t* payload, uint8_t length, uint8_t* frame)
+{
+  putLe16(&payload[length], computeTelemetryCrc(payload, length));
+
+  frame[0] = 0;
+  encodeTelemetryCobs(&frame[1], payload, length + CRC_LENGTH);
+  frame[length + TELEMETRY_FRAME_OVERHEAD - 1] = 0;
+
+  return length + TELEMETRY_FRAME_OVERHEAD;
+}
+
+// FUNCTION      : sendTelemetryFrame
+// DESCRIPTION   :
+//    Frames a payload with buildTelemetryFrame() and queues the frame for
+//    USART2. Does not block.
+// PARAMETERS    :
+//    const uint8_t* payload : Payload, the first byte tells the frame type.
+//    uint8_t length         : Length of the payload, TELEMETRY_MAX_PAYLOAD at most.
+// RETURNS       : None
+void sendTelemetryFrame(const uint8_t* payload, uint8_t length)
+{
+  uint8_t buffer[TELEMETRY_MAX_PAYLOAD + CRC_LENGTH];
+  uint8_t frame[TELEMETRY_MAX_PAYLOAD + TELEMETRY_FRAME_OVERHEAD];
+
+  if (length > TELEMETRY_MAX_PAYLOAD)
+  {
+    return;
+  }
+
+  memcpy(buffer, payload, length);
+  port_tx_msg(frame, buildTelemetryFrame(buffer, length, frame));
+}
+
+// FUNCTION      : sendTelemetry
+// DESCRIPTION   :
+//    Stamps a record with the next sequence number and the time and queues it
+//    for USART2. Does not block. Call once per ranging exchange, also for the
+//    exchanges without a range.
+// PARAMETERS    :
+//    TelemetryRecord* record : Result of the exchange.
+// RETURNS       : None
+void sendTelemetry(TelemetryRecord* record)
+{
+#if (TELEMETRY_ENABLE == 1)
+  uint8_t payload[RECORD_LENGTH];
+  const uint32_t drops = port_tx_dropped();
+
+  if (drops != reportedDrops)
+  {
+    record->flags |= TLM_FLAG_LOG_DROPPED;
+    reportedDrops = drops;
+  }
+
+  payload[0] = TELEMETRY_VERSION;
+  payload[1] = record->flags;
+  putLe16(&payload[2], sequence++);
+  putLe32(&payload[4], HAL_GetTick());
+  putLe32(&payload[8], (uint32_t)record->rangeMm);
+  putLe16(&payload[12], (uint16_t)record->clockOffset);
+  putLe16(&payload[14], record->fpIndex);
+  putLe32(&payload[16], record->cirPeak);
+  putLe32(&payload[20], record->cirPower);
+  putLe16(&payload[24], record->accumCount);
+
+  sendTelemetryFrame(payload, RECORD_LENGTH);
+#else
+  (void)record;
+#endif
+}
@@ -0,0 +1,118 @@
+/*******************************************************************************
+  * File Name          : text_field.c
+  * Description        :
+  *    A fixed size text field on the SSD1331 OLED display that only redraws the
+  *    character cells that changed since the last update.
+  ******************************************************************************
+  */
+#include "text_field.h"
+#include "tlog.h"
+#include <string.h>
+
+// Private defines
+#define SSD1331_WIDTH     96
+#define SSD1331_HEIGHT    64
+
+// FUNCTION      : initTextField
+// DESCRIPTION   :
+//    Places a text field of numOfCells characters on a corner of the display.
+//    The field is assumed to be blank on display (Ex: right after clearDisplay()).
+// PARAMETERS    :
+//    TextField* field     : Text field to be initialised.
+//    uint8_t numOfCells   : Width of the field in characters.
+//    FontSize fontSize    : Font size of the text.
+//    TextAlign align      : Alignment of text shorter than the field.
+//    Corner corner        : The corner which the field is placed.
+// RETURNS       : None
+void initTextField(TextField* field, uint8_t numOfCells, FontSize fontSize, TextAlign align, Corner corner)
+{
+  const uint8_t fontWidth = fontSize / 2;
+
+  if (numOfCells > TEXT_FIELD_MAX_CHARS || (numOfCells * fontWidth) > SSD1331_WIDTH)
+  {
+    TLOG("[text_field::initTextField] Error! Text field is too wide to display");
+    numOfCells = SSD1331_WIDTH / fontWidth;
+    if (numOfCells > TEXT_FIELD_MAX_CHARS)
+    {
+      numOfCells = TEXT_FIELD_MAX_CHARS;
+    }
+  }
+
+  field->posX = 0;
+  field->posY = 0;
+  field->numOfCells = numOfCells;
+  field->fontSize = fontSize;
+  field->align = align;
+  field->colour = WHITE;
+  memset(field->cells, ' ', numOfCells);
+  field->cells[numOfCells] = '\0';
+
+  if (corner == TOP_RIGHT || corner == BOTTOM_RIGHT)
+  {
+    field->posX = SSD1331_WIDTH - (numOfCells * fontWidth);
+  }
+
+  if (corner == BOTTOM_LEFT || corner == BOTTOM_RIGHT)
+  {
+    field->posY = SSD1331_HEIGHT - fontSize;
+  }
+}
+
+// FUNCTION      : updateTextField
+// DESCRIPTION   :
+//    Shows a new text in the field. The text is padded with spaces to the width
+//    of the field and only the cells that differ from what is on display are
+//    redrawn, so a change in the number of characters needs no clearing.
+//    When the colour changes, all the visible characters are redrawn.
+//    Text longer than the field is cut.
+// PARAMETERS    :
+//    TextField* field     : Text field to be updated.
+//    const char* text     : New text.
+//    enum Color txtColour : Font colour.
+// RETURNS       : None
+void updateTextField(TextField* field, const char* text, enum Color txtColour)
+{
+  const uint8_t fontWidth = field->fontSize / 2;
+  const uint8_t colourChanged = (txtColour != field->colour);
+  char newCells[TEXT_FIELD_MAX_CHARS];
+  uint8_t txtLength = strlen(text);
+  uint8_t padding = 0;
+  uint8_t i;
+
+  if (txtLength > field->numOfCells)
+  {
+    txtLength = field->numOfCells;
+  }
+
+  if (field->align == ALIGN_RIGHT)
+  {
+    padding = field->numOfCells - txtLength;
+  }
+
+  memset(newCells, ' ', field->numOfCells);
+  memcpy(&newCells[padding], text, txtLength);
+
+  for (i = 0; i < field->numOfCells; i++)
+  {
+    // A space looks the same in any colour
+    if (newCells[i] != field->cells[i] || (colourChanged && newCells[i] != ' '))
+    {
+      ssd1331_display_char(field->posX + i * fontWidth, field->posY, newCells[i], field->fontSize, txtColour);
+      field->cells[i] = newCells[i];
+    }
+  }
+
+  field->colour = txtColour;
+  ssd1331_flush();
+}
+
+// FUNCTION      : clearTextField
+// DESCRIPTION   :
+//    Blanks the text field, only erasing the cells that are not already blank.
+// PARAMETERS    :
+//    TextField* field : Text field to be cleared.
+// RETURNS       : None
+void clearTextField(TextField* field)
+{
+  updateTextField(field, "", field->colour);
+}
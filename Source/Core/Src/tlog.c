@@ -0,0 +1,36 @@
+/*******************************************************************************
+  * File Name          : tlog.c
+  * Description        :
+  *    Tokenised logging, see tlog.h. A message with two arguments is a
+  *    16-byte frame on the wire, against about 60 bytes of text for the
+  *    error messages of this firmware, and needs no printf formatting.
+  ******************************************************************************
+  */
+#include "tlog.h"
+#include "telemetry.h"
+
+// Private defines
+#define HEADER_LENGTH 3 // Frame type and token
+
+// FUNCTION      : sendLog
+// DESCRIPTION   :
+//    Queues a log message for USART2. Called by TLOG(). Does not block and
+//    can be called from interrupts.
+// PARAMETERS    :
+//    uint16_t token         : Token of the format string.
+//    const uint32_t* args   : Arguments, converted by TLOG_ARG().
+//    uint8_t numOfArgs      : Number of arguments, TLOG_MAX_ARGS at most.
+// RETURNS       : None
+void sendLog(uint16_t token, const uint32_t* args, uint8_t numOfArgs)
+{
+  uint8_t payload[HEADER_LENGTH + TLOG_MAX_ARGS * sizeof(uint32_t)];
+
+  payload[0] = TLOG_FRAME_TYPE;
+  payload[1] = token;
+  payload[2] = token >> 8;
+
+  // Cortex-M is little endian, the words go out as they are
+  memcpy(&payload[HEADER_LENGTH], args, numOfArgs * sizeof(uint32_t));
+
+  sendTelemetryFrame(payload, HEADER_LENGTH + numOfArgs * sizeof(uint32_t));
+}
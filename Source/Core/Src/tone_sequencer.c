@@ -0,0 +1,253 @@
+/*******************************************************************************
+  * File Name          : tone_sequencer.c
+  * Description        :
+  *    Plays looping sequences of (frequency, duration) steps on the buzzer
+  *    with TIM1 DMA burst updates, without CPU involvement.
+  *
+  *    A sequence is compiled once into one DMA burst per step, holding the
+  *    TIMx_ARR, TIMx_RCR and TIMx_CCR4 values of that step. TIM1 runs
+  *    continuously and its repetition counter sets the length of the step,
+  *    so an update event marks the end of each step. On every update event,
+  *    DMA2 Stream5 writes the burst of the step after next into the preload
+  *    registers through TIMx_DMAR. The stream runs in circular mode, so the
+  *    sequence repeats until it is stopped.
+  *
+  *    The registers are preloaded, so the DMA always runs one step ahead of
+  *    the timer. The first step is therefore written to the registers by
+  *    software, and it is stored last in the DMA buffer.
+  *
+  *    playToneSequence() switches to another sequence at the end of the
+  *    current loop. It only enables the DMA transfer complete interrupt; the
+  *    switch is done there, while the timer plays the last step.
+  ******************************************************************************
+  */
+#include "tone_sequencer.h"
+#include "tim.h"
+#include "tlog.h"
+#include <string.h>
+
+// Private defines
+#define BURST_LENGTH       (sizeof(ToneBurst) / sizeof(uint16_t)) // TIMx_ARR to TIMx_CCR4
+#define MAX_STEP_PERIODS   256  // TIM1 repetition counter is 8 bits
+#define SILENCE_FREQ_HZ    1000 // Timer period used while silent, 1 ms
+
+#define hdmaUpdate         (htim1.hdma[TIM_DMA_ID_UPDATE]) // DMA2 Stream5, see HAL_TIM_Base_MspInit()
+
+// Private global variables
+static volatile uint8_t isPlaying = 0;
+static const ToneSequence* volatile currentSequence = NULL;
+static const ToneSequence* volatile pendingSequence = NULL;
+
+// FUNCTION      : loadSequence
+// DESCRIPTION   :
+//    Writes the first step of a sequence to the preload registers and points
+//    the DMA at the rest of it. The timer takes the first step at its next
+//    update event, and that event also requests the first burst.
+// PARAMETERS    :
+//    const ToneSequence* sequence : Sequence to be loaded.
+// RETURNS       : None
+static void loadSequence(const ToneSequence* sequence)
+{
+  const ToneBurst* first = &sequence->bursts[sequence->numOfBursts - 1];
+  TIM_TypeDef* timer = htim1.Instance;
+
+  if (hdmaUpdate->State == HAL_DMA_STATE_BUSY)
+  {
+    HAL_DMA_Abort(hdmaUpdate);
+  }
+
+  timer->ARR = first->period;
+  timer->RCR = first->repetitions;
+  timer->CCR4 = first->pulse;
+  currentSequence = sequence;
+
+  HAL_DMA_Start(hdmaUpdate, (uint32_t)sequence->bursts, (uint32_t)&timer->DMAR,
+                sequence->numOfBursts * BURST_LENGTH);
+}
+
+// FUNCTION      : sequenceLoopEndCallback
+// DESCRIPTION   :
+//    DMA transfer complete callback. It is only enabled while a switch is
+//    pending. It runs when the last burst of the loop has been written, so the
+//    timer is playing the last step and the preload registers hold the first
+//    one. Loading the next sequence here replaces that first step.
+// PARAMETERS    :
+//    DMA_HandleTypeDef* hdma : DMA handle.
+// RETURNS       : None
+static void sequenceLoopEndCallback(DMA_HandleTypeDef* hdma)
+{
+  const ToneSequence* next = pendingSequence;
+
+  pendingSequence = NULL;
+  if (next == NULL)
+  {
+    __HAL_DMA_DISABLE_IT(hdma, DMA_IT_TC);
+    return;
+  }
+
+  // HAL_DMA_Abort() inside loadSequence() also disables this interrupt again
+  loadSequence(next);
+}
+
+// FUNCTION      : compileToneSequence
+// DESCRIPTION   :
+//    Compiles steps into the timer register values of each DMA burst. Steps
+//    longer than 256 tone periods are split over several bursts. Call at
+//    initialization; playing the result needs no computation.
+// PARAMETERS    :
+//    const ToneStep* steps  : Steps of the sequence, in playing order.
+//    uint8_t numOfSteps     : Number of steps.
+//    BuzzerVolume volume    : Volume of the tones.
+//    ToneSequence* sequence : Compiled sequence.
+// RETURNS       :
+//    uint8_t : 1 on success, 0 if a step is invalid or the sequence is too long.
+uint8_t compileToneSequence(const ToneStep* steps, uint8_t numOfSteps, BuzzerVolume volume, ToneSequence* sequence)
+{
+  PwmRegisters regs;
+  ToneBurst first;
+  uint32_t periods;
+  uint32_t burstPeriods;
+  uint16_t freqHz;
+  uint8_t count = 0;
+  uint8_t i;
+
+  for (i = 0; i < numOfSteps; i++)
+  {
+    freqHz = steps[i].freqHz ? steps[i].freqHz : SILENCE_FREQ_HZ;
+    if (!computeBuzzerRegisters(freqHz, steps[i].freqHz ? volume : VOLUME_MUTE, &regs))
+    {
+      return 0;
+    }
+
+    periods = (uint32_t)steps[i].durationMs * freqHz / 1000;
+    if (periods == 0)
+    {
+      periods = 1;
+    }
+
+    while (periods > 0)
+    {
+      if (count == TONE_SEQ_MAX_BURSTS)
+      {
+        TLOG("[tone_sequencer::compileToneSequence] Error! Sequence is too long.");
+        return 0;
+      }
+
+      burstPeriods = (periods > MAX_STEP_PERIODS) ? MAX_STEP_PERIODS : periods;
+      memset(&sequence->bursts[count], 0, sizeof(ToneBurst));
+      sequence->bursts[count].period = regs.period;
+      sequence->bursts[count].repetitions = burstPeriods - 1;
+      sequence->bursts[count].pulse = regs.pulse;
+      count++;
+      periods -= burstPeriods;
+    }
+  }
+
+  if (count == 0)
+  {
+    TLOG("[tone_sequencer::compileToneSequence] Error! Empty sequence.");
+    return 0;
+  }
+
+  // The first step is written by software when loading, the DMA starts from the second
+  first = sequence->bursts[0];
+  memmove(&sequence->bursts[0], &sequence->bursts[1], (count - 1) * sizeof(ToneBurst));
+  sequence->bursts[count - 1] = first;
+  sequence->numOfBursts = count;
+
+  return 1;
+}
+
+// FUNCTION      : playToneSequence
+// DESCRIPTION   :
+//    Starts playing a sequence in a loop, or, if one is already playing,
+//    switches to it at the end of the current loop. Asking for the sequence
+//    that is already playing does nothing. Does not block, so it can be
+//    called from the ranging path. The sequence must stay in memory while it
+//    plays. Call buzzerOn() first.
+// PARAMETERS    :
+//    const ToneSequence* sequence : Compiled sequence.
+// RETURNS       : None
+void playToneSequence(const ToneSequence* sequence)
+{
+  TIM_TypeDef* timer = htim1.Instance;
+  uint32_t primask;
+
+  if (sequence == NULL || sequence->numOfBursts == 0)
+  {
+    return;
+  }
+
+  if (isPlaying)
+  {
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (sequence == currentSequence)
+    {
+      // Cancels a pending switch, if any; the callback then only disables itself
+      pendingSequence = NULL;
+    }
+    else
+    {
+      pendingSequence = sequence;
+      __HAL_DMA_ENABLE_IT(hdmaUpdate, DMA_IT_TC);
+    }
+    __set_PRIMASK(primask);
+    return;
+  }
+
+  // TIM1 normally plays the beeps of the buzzer cadence: one-pulse mode, started by TIM2.
+  // Let it run freely instead.
+  stopBuzzerCadence();
+  timer->CR1 &= ~(TIM_CR1_CEN | TIM_CR1_OPM);
+  timer->SMCR &= ~TIM_SMCR_SMS;
+
+  hdmaUpdate->XferCpltCallback = sequenceLoopEndCallback;
+  timer->DCR = TIM_DMABASE_ARR | TIM_DMABURSTLENGTH_6TRANSFERS;
+  loadSequence(sequence);
+
+  // The update event loads the first step at once and requests the burst of the second
+  __HAL_TIM_ENABLE_DMA(&htim1, TIM_DMA_UPDATE);
+  timer->EGR = TIM_EGR_UG;
+  timer->CR1 |= TIM_CR1_CEN;
+
+  isPlaying = 1;
+}
+
+// FUNCTION      : stopToneSequence
+// DESCRIPTION   :
+//    Stops the sequence at once and hands TIM1 back to the buzzer cadence.
+// PARAMETERS    : None
+// RETURNS       : None
+void stopToneSequence(void)
+{
+  TIM_TypeDef* timer = htim1.Instance;
+
+  if (!isPlaying)
+  {
+    return;
+  }
+
+  pendingSequence = NULL;
+  HAL_DMA_Abort(hdmaUpdate);
+  __HAL_TIM_DISABLE_DMA(&htim1, TIM_DMA_UPDATE);
+
+  // With the counter back at 0 the PWM mode 2 output is low
+  timer->CR1 &= ~TIM_CR1_CEN;
+  timer->CNT = 0;
+  timer->CR1 |= TIM_CR1_OPM;
+  timer->SMCR = (timer->SMCR & ~TIM_SMCR_SMS) | TIM_SLAVEMODE_TRIGGER;
+  applyBuzzerSettings();
+
+  isPlaying = 0;
+}
+
+// FUNCTION      : isToneSequencePlaying
+// DESCRIPTION   : Tells whether a sequence is playing.
+// PARAMETERS    : None
+// RETURNS       :
+//    uint8_t : 1 while a sequence is playing, 0 otherwise.
+uint8_t isToneSequencePlaying(void)
+{
+  return isPlaying;
+}
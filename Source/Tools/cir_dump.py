@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+"""Stores the CIR dumps of the firmware (Core/Inc/cir_capture.h) in an indexed file and reads them back.
+
+The firmware sends the dumps on USART2 between the telemetry records and log
+messages:
+
+    frame      0x00, COBS(dump, CRC-16/CCITT low byte first), 0x00
+    dump       28-byte header, starting with 0xC1, then 6 bytes per sample
+
+File format, little endian:
+
+    header     b"UWBCIR\\0\\0", uint32 version (1), uint32 reserved
+    dumps      each dump as sent, header and samples, without the CRC
+    index      one entry per dump: uint64 offset, uint32 length,
+               uint32 timestampMs, uint16 sequence, uint8 flags, uint8 reserved
+    footer     uint64 index offset, uint32 dump count, b"CIRX"
+
+The index is written when the input ends or on Ctrl-C, so any dump can be
+read with one seek. CirDumpFile reads such a file from other scripts:
+
+    from cir_dump import CirDumpFile
+    dumps = CirDumpFile("dumps.cir")
+    header, samples = dumps[10]        # samples: list of complex
+
+Usage: python3 Tools/cir_dump.py capture [-o FILE] [input]
+       python3 Tools/cir_dump.py list FILE
+       python3 Tools/cir_dump.py show FILE N
+    capture    store the dumps of a capture file or serial port in raw mode,
+               standard input by default, to FILE, dumps.cir by default
+    list       one line per dump
+    show       samples of dump N as CSV: sample, real, imag, magnitude
+"""
+import os
+import struct
+import sys
+
+CIR_FRAME_TYPE = 0xC1
+CIR_FLAG_FULL = 0x01
+FILE_MAGIC = b"UWBCIR\0\0"
+FILE_VERSION = 1
+FOOTER_MAGIC = b"CIRX"
+
+FILE_HEADER = struct.Struct("<8sII")
+INDEX_ENTRY = struct.Struct("<QIIHBB")
+FOOTER = struct.Struct("<QI4s")
+DUMP_HEADER = struct.Struct("<BBHIHHHHIBBBBBBBB")
+DUMP_FIELDS = ("type", "version", "sequence", "timestampMs", "firstSample", "numSamples",
+               "fpIndex", "accumCount", "cirPeak", "flags", "chan", "txPreambLength",
+               "rxPAC", "rxCode", "sfdType", "dataRate", "reserved")
+SAMPLE_BYTES = 6
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = (crc << 1 ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xFFFF
+    return crc
+
+
+def decode_cobs(chunk):
+    out, i = bytearray(), 0
+    while i < len(chunk):
+        code = chunk[i]
+        if code == 0 or i + code > len(chunk):
+            return None
+        out += chunk[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(chunk):
+            out.append(0)
+    return bytes(out)
+
+
+def parse_dump(dump):
+    """Returns the header as a dict and the samples as a list of complex."""
+    header = dict(zip(DUMP_FIELDS, DUMP_HEADER.unpack_from(dump)))
+    samples = []
+    for i in range(header["numSamples"]):
+        raw = dump[DUMP_HEADER.size + i * SAMPLE_BYTES:DUMP_HEADER.size + (i + 1) * SAMPLE_BYTES]
+        real = int.from_bytes(raw[0:3], "little") & 0x3FFFF
+        imag = int.from_bytes(raw[3:6], "little") & 0x3FFFF
+        samples.append(complex(real - (real & 0x20000) * 2, imag - (imag & 0x20000) * 2))
+    return header, samples
+
+
+class CirDumpFile:
+    """Random access to the dumps of a file written by capture."""
+
+    def __init__(self, path):
+        self.file = open(path, "rb")
+        magic, version, _ = FILE_HEADER.unpack(self.file.read(FILE_HEADER.size))
+        if magic != FILE_MAGIC or version != FILE_VERSION:
+            raise ValueError("%s is not a CIR dump file" % path)
+        self.file.seek(-FOOTER.size, os.SEEK_END)
+        index_offset, count, magic = FOOTER.unpack(self.file.read(FOOTER.size))
+        if magic != FOOTER_MAGIC:
+            raise ValueError("%s has no index, the capture did not finish" % path)
+        self.file.seek(index_offset)
+        data = self.file.read(count * INDEX_ENTRY.size)
+        self.index = [INDEX_ENTRY.unpack_from(data, i * INDEX_ENTRY.size) for i in range(count)]
+
+    def __len__(self):
+        return len(self.index)
+
+    def __getitem__(self, n):
+        offset, length = self.index[n][:2]
+        self.file.seek(offset)
+        return parse_dump(self.file.read(length))
+
+
+def capture(fd, path):
+    counts = {"dumps": 0, "other frames": 0, "bad frames": 0, "text bytes": 0}
+    index = []
+    chunk = bytearray()
+    with open(path, "wb") as out:
+        out.write(FILE_HEADER.pack(FILE_MAGIC, FILE_VERSION, 0))
+        try:
+            while True:
+                data = os.read(fd, 65536)
+                if not data:
+                    break
+                for b in data:
+                    if b:
+                        chunk.append(b)
+                        continue
+                    if not chunk:
+                        continue
+                    payload = decode_cobs(chunk)
+                    if payload and len(payload) > 2 and crc16(payload[:-2]) == payload[-2] | payload[-1] << 8:
+                        dump = payload[:-2]
+                        header = None
+                        if dump[0] == CIR_FRAME_TYPE and len(dump) >= DUMP_HEADER.size:
+                            header = dict(zip(DUMP_FIELDS, DUMP_HEADER.unpack_from(dump)))
+                        if header and len(dump) == DUMP_HEADER.size + header["numSamples"] * SAMPLE_BYTES:
+                            index.append((out.tell(), len(dump), header["timestampMs"], header["sequence"],
+                                          header["flags"], 0))
+                            out.write(dump)
+                            counts["dumps"] += 1
+                        else:
+                            counts["other frames"] += 1
+                    elif all(32 <= c < 127 or c in b"\r\n\t" for c in chunk):
+                        counts["text bytes"] += len(chunk)
+                    else:
+                        counts["bad frames"] += 1
+                    chunk.clear()
+        except KeyboardInterrupt:
+            pass
+        index_offset = out.tell()
+        for entry in index:
+            out.write(INDEX_ENTRY.pack(*entry))
+        out.write(FOOTER.pack(index_offset, len(index), FOOTER_MAGIC))
+    sys.stderr.write(", ".join("%s %d" % item for item in counts.items()) + "\n")
+
+
+def main():
+    args = sys.argv[1:]
+    if args[:1] == ["capture"]:
+        path = "dumps.cir"
+        if args[1:2] == ["-o"] and len(args) > 2:
+            path = args[2]
+            args = args[2:]
+        if len(args) > 2:
+            sys.exit(__doc__)
+        capture(os.open(args[1], os.O_RDONLY) if len(args) > 1 else sys.stdin.fileno(), path)
+    elif args[:1] == ["list"] and len(args) == 2:
+        dumps = CirDumpFile(args[1])
+        print("dump,sequence,timestampMs,firstSample,numSamples,fpIndex,accumCount,full")
+        for n in range(len(dumps)):
+            h = dumps[n][0]
+            print("%d,%d,%d,%d,%d,%.2f,%d,%d" % (n, h["sequence"], h["timestampMs"], h["firstSample"],
+                                                h["numSamples"], h["fpIndex"] / 64.0, h["accumCount"],
+                                                h["flags"] & CIR_FLAG_FULL))
+    elif args[:1] == ["show"] and len(args) == 3:
+        header, samples = CirDumpFile(args[1])[int(args[2])]
+        print("sample,real,imag,magnitude")
+        for i, s in enumerate(samples):
+            print("%d,%d,%d,%.1f" % (header["firstSample"] + i, s.real, s.imag, abs(s)))
+    else:
+        sys.exit(__doc__)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,179 @@
+#!/usr/bin/env python3
+"""Dumps the ranging log kept in flash by the firmware (Core/Inc/flash_log.h) and prints it as CSV.
+
+On a serial port the script sends the dump command 'D' and reads until the end
+frame. A capture file or standard input is decoded as it is. The dump frames
+are
+
+    frame      0x00, COBS(payload, CRC-16/CCITT low byte first), 0x00
+    0xD1       sector sequence (4), offset (4), up to 192 bytes of the sector
+    0xD2       number of 0xD1 frames (2), dropped records (4), flags (1)
+
+Other frames and text in the stream are skipped. One line is printed per
+ranging exchange; session counts the power ups in the log, 0 for a session
+whose start has been erased, and the timestamp is the time since that power
+up:
+
+    session,timestamp_ms,flags,range_mm
+
+Usage: python3 Tools/flash_log.py [--raw FILE] [input]
+    --raw      also write the sectors as dumped, in log order, to FILE
+    input      serial port in raw mode, e.g. /dev/ttyACM0 after
+               stty -F /dev/ttyACM0 921600 raw, or a capture file;
+               standard input by default
+"""
+import os
+import stat
+import struct
+import sys
+
+DUMP_FRAME = 0xD1
+END_FRAME = 0xD2
+DUMP_COMMAND = b"D"
+DUMP_ABORTED = 0x01
+MAGIC = 0x474F4C55
+VERSION = 1
+HEADER_LENGTH = 16
+SESSION = 0x01
+RANGE = 0x02
+RANGE_VALID = 0x01
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = (crc << 1 ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xFFFF
+    return crc
+
+
+def decode_cobs(chunk):
+    out, i = bytearray(), 0
+    while i < len(chunk):
+        code = chunk[i]
+        if code == 0 or i + code > len(chunk):
+            return None
+        out += chunk[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(chunk):
+            out.append(0)
+    return bytes(out)
+
+
+def read_varint(data, i):
+    value, shift = 0, 0
+    while True:
+        b = data[i]
+        value |= (b & 0x7F) << shift
+        i += 1
+        if not b & 0x80:
+            return value, i
+        shift += 7
+
+
+def read_dump(fd):
+    """Returns the sectors as {sequence: bytearray} and the end frame, None if it did not arrive."""
+    sectors, end, chunk = {}, None, bytearray()
+    while end is None:
+        data = os.read(fd, 4096)
+        if not data:
+            break
+        for b in data:
+            if b:
+                chunk.append(b)
+                continue
+            payload = decode_cobs(chunk) if chunk else None
+            chunk.clear()
+            if not payload or len(payload) < 3 or crc16(payload[:-2]) != payload[-2] | payload[-1] << 8:
+                continue
+            payload = payload[:-2]
+            if payload[0] == DUMP_FRAME and len(payload) >= 9:
+                sequence, offset = struct.unpack_from("<II", payload, 1)
+                sector = sectors.setdefault(sequence, bytearray())
+                if len(sector) < offset + len(payload) - 9:
+                    sector.extend(b"\xff" * (offset + len(payload) - 9 - len(sector)))
+                sector[offset:offset + len(payload) - 9] = payload[9:]
+            elif payload[0] == END_FRAME and len(payload) >= 8:
+                end = struct.unpack_from("<HIB", payload, 1)
+                break
+    return sectors, end
+
+
+def decode_sector(sector, state, out, counts):
+    """Prints the records of one sector. state is [session, timestamp, range]."""
+    magic, sequence, version = struct.unpack_from("<IIB", sector) if len(sector) >= HEADER_LENGTH else (0, 0, 0)
+    if magic != MAGIC or version != VERSION or crc16(sector[:14]) != sector[14] | sector[15] << 8:
+        counts["bad sectors"] += 1
+        return
+    # The deltas start over at the start of a sector
+    state[1], state[2] = 0, 0
+    i = HEADER_LENGTH
+    while i < len(sector) and sector[i] != 0xFF:
+        length = sector[i]
+        if length == 0:
+            i += 1
+            continue
+        record = sector[i:i + 1 + length + 2]
+        i += 1 + length + 2
+        if len(record) < length + 3 or crc16(record[:-2]) != record[-2] | record[-1] << 8:
+            counts["bad records"] += 1
+            continue
+        payload = record[1:-2]
+        if payload[0] == SESSION:
+            state[0] += 1
+            state[1], state[2] = 0, 0
+            counts["sessions"] += 1
+        elif payload[0] == RANGE:
+            dt, j = read_varint(payload, 1)
+            flags = payload[j]
+            state[1] += dt
+            range_mm = ""
+            if flags & RANGE_VALID:
+                zigzag, j = read_varint(payload, j + 1)
+                state[2] += (zigzag >> 1) ^ -(zigzag & 1)
+                range_mm = str(state[2])
+            out.write("%d,%d,0x%02X,%s\n" % (state[0], state[1], flags, range_mm))
+            counts["records"] += 1
+
+
+def main():
+    args = sys.argv[1:]
+    raw = None
+    if args[:1] == ["--raw"] and len(args) > 1:
+        raw = args[1]
+        args = args[2:]
+    if len(args) > 1 or args and args[0].startswith("-"):
+        sys.exit(__doc__)
+
+    fd = sys.stdin.fileno()
+    if args:
+        is_port = stat.S_ISCHR(os.stat(args[0]).st_mode)
+        fd = os.open(args[0], os.O_RDWR if is_port else os.O_RDONLY)
+        if is_port:
+            os.write(fd, DUMP_COMMAND)
+    sectors, end = read_dump(fd)
+
+    counts = {"records": 0, "sessions": 0, "bad records": 0, "bad sectors": 0}
+    state = [0, 0, 0]
+    sys.stdout.write("session,timestamp_ms,flags,range_mm\n")
+    for sequence in sorted(sectors):
+        decode_sector(sectors[sequence], state, sys.stdout, counts)
+    if raw:
+        with open(raw, "wb") as f:
+            for sequence in sorted(sectors):
+                f.write(sectors[sequence])
+
+    summary = ", ".join("%s %d" % item for item in counts.items())
+    if end is None:
+        summary += ", no end frame, the dump is incomplete"
+    else:
+        _, drops, flags = end
+        summary += ", dropped by the firmware %d" % drops
+        if flags & DUMP_ABORTED:
+            summary += ", aborted by a sector erase"
+    sys.stderr.write(summary + "\n")
+
+
+if __name__ == "__main__":
+    main()
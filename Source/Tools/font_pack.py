@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""Packs the bitmap fonts in Core/Src/fonts.c into Core/Src/fonts_packed.c.
+
+The source arrays store each glyph column by column, top to bottom, MSB first.
+The packed format keeps only the bounding box of the set pixels of each glyph,
+row by row, so blank margins cost nothing and a glyph row can be fetched with
+one unaligned read (see font_glyph_row() in fonts.c):
+
+    byte 0     x0 << 4 | (width - 1)   bounding box, columns
+    byte 1     y0                      bounding box, first row
+    byte 2     height                  rows in the box, 0 for a blank glyph
+    bytes 3..  width * height bits, row by row, MSB first, rows not byte aligned
+
+Every table ends with two padding bytes so the decoder may always read three
+bytes from any bit offset.
+
+Usage: python3 Tools/font_pack.py [--check]
+    --check  only print the sizes, do not write fonts_packed.c
+"""
+import os
+import re
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+SRC = os.path.join(ROOT, "Core", "Src", "fonts.c")
+DST = os.path.join(ROOT, "Core", "Src", "fonts_packed.c")
+
+# (array in fonts.c, packed name, cell width, cell height, first character)
+FONTS = [
+    ("c_chFont1206", "1206", 6, 12, 0x20),
+    ("c_chFont1608", "1608", 8, 16, 0x20),
+    ("c_chFont1612", "1612", 16, 16, 0x30),
+    ("c_chFont3216", "3216", 16, 32, 0x30),
+]
+
+
+def read_array(text, name):
+    m = re.search(r"const uint8_t " + name + r"\[(\d+)\]\[(\d+)\]\s*=\s*\{(.*?)\n\};", text, re.S)
+    if not m:
+        sys.exit("%s not found in %s" % (name, SRC))
+    count, length = int(m.group(1)), int(m.group(2))
+    body = re.sub(r"/\*.*?\*/", "", m.group(3), flags=re.S)
+    data = [int(x, 16) for x in re.findall(r"0x[0-9A-Fa-f]{2}", body)]
+    if len(data) != count * length:
+        sys.exit("%s: expected %d bytes, found %d" % (name, count * length, len(data)))
+    return [data[i * length:(i + 1) * length] for i in range(count)]
+
+
+def unpack_columns(glyph, width, height):
+    col_bytes = (height + 7) // 8
+    return [[(glyph[c * col_bytes + r // 8] >> (7 - r % 8)) & 1 for c in range(width)]
+            for r in range(height)]
+
+
+def pack_glyph(pixels, width, height):
+    rows = [r for r in range(height) if any(pixels[r])]
+    if not rows:
+        return [0, 0, 0]
+    cols = [c for c in range(width) if any(pixels[r][c] for r in rows)]
+    x0, x1, y0, y1 = cols[0], cols[-1], rows[0], rows[-1]
+    bits = [pixels[r][c] for r in range(y0, y1 + 1) for c in range(x0, x1 + 1)]
+    bits += [0] * (-len(bits) % 8)
+    out = [x0 << 4 | (x1 - x0), y0, y1 - y0 + 1]
+    for i in range(0, len(bits), 8):
+        out.append(int("".join(map(str, bits[i:i + 8])), 2))
+    return out
+
+
+def char_name(code):
+    return chr(code) if chr(code) not in "*/\\" else "\\x%02X" % code
+
+
+def emit_font(out, name, width, height, first, glyphs):
+    offsets, data = [], []
+    for glyph in glyphs:
+        offsets.append(len(data))
+        data.append(pack_glyph(unpack_columns(glyph, width, height), width, height))
+    size = sum(len(g) for g in data) + 2
+    if size > 0xFFFF:
+        sys.exit("%s: packed data too large for 16 bit offsets" % name)
+
+    out.append("static const uint16_t c_hwFont%sOffset[%d] = {" % (name, len(glyphs)))
+    offset = 0
+    for i, g in enumerate(data):
+        out.append("\t%d,/*\"%s\",%d*/" % (offset, char_name(first + i), i))
+        offset += len(g)
+    out.append("};")
+    out.append("")
+    out.append("static const uint8_t c_chFont%sPacked[%d] = {" % (name, size))
+    for i, g in enumerate(data):
+        out.append("\t" + "".join("0x%02X," % b for b in g) + "/*\"%s\",%d*/" % (char_name(first + i), i))
+    out.append("\t0x00,0x00,/*padding*/")
+    out.append("};")
+    out.append("")
+    out.append("const font_packed_t c_tFont%s = {%d, %d, 0x%02X, %d, c_hwFont%sOffset, c_chFont%sPacked};"
+               % (name, width, height, first, len(glyphs), name, name))
+    out.append("")
+    return size + 2 * len(glyphs)
+
+
+def main():
+    with open(SRC) as f:
+        text = f.read()
+
+    out = [
+        "/* Generated by Tools/font_pack.py from the arrays in fonts.c, do not edit. */",
+        "#include <stdint.h>",
+        "#include \"fonts.h\"",
+        "",
+    ]
+    total_raw = total_packed = 0
+    for array, name, width, height, first in FONTS:
+        glyphs = read_array(text, array)
+        raw = sum(len(g) for g in glyphs)
+        packed = emit_font(out, name, width, height, first, glyphs)
+        print("%-14s %5d B -> %5d B (%d%%)" % (array, raw, packed, 100 * packed // raw))
+        total_raw += raw
+        total_packed += packed
+    print("%-14s %5d B -> %5d B, %d B saved" % ("total", total_raw, total_packed, total_raw - total_packed))
+    out.append("/*-------------------------------END OF FILE-------------------------------*/")
+
+    if "--check" not in sys.argv:
+        with open(DST, "w") as f:
+            f.write("\n".join(out) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+"""Turns the tokenised log messages of the firmware (Core/Inc/tlog.h) back into text.
+
+The format strings never leave the build: they are in the .tlog_fmt section
+of the ELF file, which is not loaded to the target. The offset of a string in
+that section is its token. This script reads that dictionary from the ELF file,
+or from a JSON file written by --dict-out, and decodes a captured stream or a
+serial port:
+
+    frame      0x00, COBS(payload, CRC-16/CCITT low byte first), 0x00
+    payload    0xF0, token (2 bytes), one 32-bit word per argument, little endian
+
+Telemetry records (Core/Inc/telemetry.h) and CIR dumps in the same stream are
+counted and skipped, use Tools/uwb_decoder and Tools/cir_dump.py for them.
+Plain text (printf output) is printed as it is.
+
+Usage: python3 Tools/tlog_decode.py (--elf FILE | --dict FILE) [--dict-out FILE] [input]
+    --elf       firmware ELF file, e.g. Debug/UWB_Rangefinder.elf; also resolves %s
+                arguments that point to strings in flash
+    --dict      dictionary written by --dict-out, for when the ELF file is not at hand
+    --dict-out  write the dictionary as JSON and exit unless an input is given
+    input       capture file or serial port in raw mode, standard input by default
+"""
+import json
+import os
+import re
+import struct
+import sys
+
+TLOG_FRAME_TYPE = 0xF0
+SECTION = ".tlog_fmt"
+SPEC = re.compile(r"%([-+ #0]*)(\d*)(?:\.(\d+))?(hh|h|ll|l|z|j|t|L)?([diouxXcsfFeEgGp%])")
+
+
+def read_elf(path):
+    """Returns the .tlog_fmt section and the loaded sections as (address, data)."""
+    with open(path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF":
+        sys.exit("%s is not an ELF file" % path)
+    is64 = elf[4] == 2
+    if is64:
+        shoff, = struct.unpack_from("<Q", elf, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", elf, 0x3A)
+        fmt = "<IIQQQQIIQQ"
+    else:
+        shoff, = struct.unpack_from("<I", elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+        fmt = "<IIIIIIIIII"
+
+    headers = [struct.unpack_from(fmt, elf, shoff + i * shentsize) for i in range(shnum)]
+    names = headers[shstrndx]
+    tlog, loaded = None, []
+    for name, sh_type, flags, addr, offset, size in (h[:6] for h in headers):
+        end = elf.index(b"\0", names[4] + name)
+        data = elf[offset:offset + size] if sh_type != 8 else b""  # 8: SHT_NOBITS
+        if elf[names[4] + name:end].decode() == SECTION:
+            tlog = data
+        elif flags & 2 and data:  # SHF_ALLOC
+            loaded.append((addr, data))
+    if tlog is None:
+        sys.exit("%s has no %s section, is the firmware built with TLOG_ENABLE?" % (path, SECTION))
+    return tlog, loaded
+
+
+def build_dictionary(section):
+    """Each string starts after a zero, strings are padded with zeros to their alignment."""
+    strings, start = {}, None
+    for i, b in enumerate(section):
+        if b and start is None:
+            start = i
+        elif not b and start is not None:
+            strings[start] = section[start:i].decode("utf-8", "replace")
+            start = None
+    return strings
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = (crc << 1 ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xFFFF
+    return crc
+
+
+def decode_cobs(chunk):
+    out, i = bytearray(), 0
+    while i < len(chunk):
+        code = chunk[i]
+        if code == 0 or i + code > len(chunk):
+            return None
+        out += chunk[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(chunk):
+            out.append(0)
+    return bytes(out)
+
+
+def read_string(loaded, address):
+    for start, data in loaded:
+        if start <= address < start + len(data):
+            end = data.find(b"\0", address - start)
+            return data[address - start:end if end >= 0 else len(data)].decode("utf-8", "replace")
+    return "<0x%08X>" % address
+
+
+def format_message(fmt, words, loaded):
+    """printf() on the host: each conversion takes one 32-bit word."""
+    args = iter(words)
+
+    def convert(m):
+        flags, width, precision, _, conv = m.groups()
+        if conv == "%":
+            return "%"
+        word = next(args, None)
+        if word is None:
+            return "<missing>"
+        spec = "%" + flags + width + ("." + precision if precision else "")
+        if conv in "di":
+            return (spec + "d") % (word - (1 << 32) if word & 0x80000000 else word)
+        if conv in "ouxX":
+            return (spec + conv) % word
+        if conv == "c":
+            return (spec + "c") % chr(word & 0xFF)
+        if conv in "fFeEgG":
+            return (spec + conv) % struct.unpack("<f", struct.pack("<I", word))[0]
+        if conv == "s":
+            return (spec + "s") % read_string(loaded, word)
+        return "0x%08x" % word
+
+    return SPEC.sub(convert, fmt)
+
+
+def is_text(chunk):
+    return all(32 <= b < 127 or b in b"\r\n\t" for b in chunk)
+
+
+def main():
+    args = sys.argv[1:]
+    options = {}
+    while args and args[0] in ("--elf", "--dict", "--dict-out") and len(args) > 1:
+        options[args[0]] = args[1]
+        args = args[2:]
+    if args and args[0].startswith("-") or ("--elf" in options) == ("--dict" in options):
+        sys.exit(__doc__)
+
+    loaded = []
+    if "--elf" in options:
+        section, loaded = read_elf(options["--elf"])
+        dictionary = build_dictionary(section)
+    else:
+        with open(options["--dict"]) as f:
+            dictionary = {int(k): v for k, v in json.load(f).items()}
+
+    if "--dict-out" in options:
+        with open(options["--dict-out"], "w") as f:
+            json.dump({str(k): v for k, v in sorted(dictionary.items())}, f, indent=1)
+        if not args:
+            return
+
+    fd = os.open(args[0], os.O_RDONLY) if args else sys.stdin.fileno()
+    out = sys.stdout
+    counts = {"messages": 0, "other frames": 0, "unknown tokens": 0, "bad frames": 0}
+    chunk = bytearray()
+    while True:
+        data = os.read(fd, 4096)
+        if not data:
+            break
+        for b in data:
+            if b:
+                chunk.append(b)
+                continue
+            if not chunk:
+                continue
+            payload = decode_cobs(chunk)
+            if payload and len(payload) > 2 and crc16(payload[:-2]) == payload[-2] | payload[-1] << 8:
+                payload = payload[:-2]
+                if payload[0] == TLOG_FRAME_TYPE and len(payload) >= 3 and (len(payload) - 3) % 4 == 0:
+                    token = payload[1] | payload[2] << 8
+                    words = struct.unpack("<%dI" % ((len(payload) - 3) // 4), payload[3:])
+                    if token in dictionary:
+                        out.write(format_message(dictionary[token], words, loaded) + "\n")
+                        counts["messages"] += 1
+                    else:
+                        out.write("<unknown token 0x%04X, %s>\n" % (token, " ".join("%08X" % w for w in words)))
+                        counts["unknown tokens"] += 1
+                else:
+                    counts["other frames"] += 1
+            elif is_text(chunk):
+                out.write(chunk.decode().replace("\r\n", "\n"))
+            else:
+                counts["bad frames"] += 1
+            chunk.clear()
+        out.flush()
+
+    sys.stderr.write(", ".join("%s %d" % item for item in counts.items()) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,176 @@
+/*******************************************************************************
+  * File Name          : record_writers.cpp
+  * Description        :
+  *    Writes decoded range records as CSV or as a columnar file.
+  ******************************************************************************
+  */
+#include "record_writers.h"
+
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+namespace uwb
+{
+
+namespace
+{
+
+constexpr char kMagic[4] = { 'U', 'W', 'B', 'C' };
+constexpr uint16_t kFormatVersion = 1;
+constexpr std::size_t kHeaderLength = 16;
+constexpr std::size_t kDirectoryEntryLength = 40;
+constexpr std::size_t kNameLength = 24;
+
+struct Column
+{
+  const char* name;
+  ColumnType type;
+  std::function<double(const RangeRecord&)> value;
+};
+
+// Every type used here is exactly representable as a double
+const std::vector<Column> kColumns =
+{
+  { "version", ColumnType::U8, [](const RangeRecord& r) { return r.version; } },
+  { "flags", ColumnType::U8, [](const RangeRecord& r) { return r.flags; } },
+  { "sequence", ColumnType::U16, [](const RangeRecord& r) { return r.sequence; } },
+  { "timestamp_ms", ColumnType::U32, [](const RangeRecord& r) { return r.timestampMs; } },
+  { "range_mm", ColumnType::I32, [](const RangeRecord& r) { return r.rangeMm; } },
+  { "clock_offset", ColumnType::I16, [](const RangeRecord& r) { return r.clockOffset; } },
+  { "fp_index", ColumnType::U16, [](const RangeRecord& r) { return r.fpIndex; } },
+  { "cir_peak", ColumnType::U32, [](const RangeRecord& r) { return r.cirPeak; } },
+  { "cir_power", ColumnType::U32, [](const RangeRecord& r) { return r.cirPower; } },
+  { "accum_count", ColumnType::U16, [](const RangeRecord& r) { return r.accumCount; } },
+  { "clock_offset_ppm", ColumnType::F64, [](const RangeRecord& r) { return r.clockOffsetPpm(); } },
+  { "rx_level_dbm", ColumnType::F64, [](const RangeRecord& r) { return r.rxLevelDbm(); } },
+};
+
+std::size_t typeSize(ColumnType type)
+{
+  switch (type)
+  {
+    case ColumnType::U8:  return 1;
+    case ColumnType::U16: return 2;
+    case ColumnType::I16: return 2;
+    case ColumnType::U32: return 4;
+    case ColumnType::I32: return 4;
+    case ColumnType::F64: return 8;
+  }
+  return 0;
+}
+
+void putLittleEndian(std::ostream& out, uint64_t value, std::size_t size)
+{
+  for (std::size_t i = 0; i < size; i++)
+  {
+    out.put(static_cast<char>(value >> (8 * i)));
+  }
+}
+
+void putValue(std::ostream& out, ColumnType type, double value)
+{
+  uint64_t bits;
+
+  switch (type)
+  {
+    case ColumnType::F64:
+      std::memcpy(&bits, &value, sizeof(bits));
+      putLittleEndian(out, bits, 8);
+      break;
+    case ColumnType::I16:
+    case ColumnType::I32:
+      putLittleEndian(out, static_cast<uint64_t>(static_cast<int64_t>(value)), typeSize(type));
+      break;
+    default:
+      putLittleEndian(out, static_cast<uint64_t>(value), typeSize(type));
+      break;
+  }
+}
+
+void padTo8(std::ostream& out, std::size_t length)
+{
+  for (; length % 8; length++)
+  {
+    out.put(0);
+  }
+}
+
+} // namespace
+
+CsvWriter::CsvWriter(std::ostream& out)
+  : out_(out)
+{
+  out_ << "sequence,timestamp_ms,flags,range_mm,clock_offset_ppm,fp_index,peak_amplitude,cir_power,accum_count,rx_level_dbm\n";
+}
+
+void CsvWriter::write(const RangeRecord& record)
+{
+  out_ << record.sequence << ',' << record.timestampMs << ',' << static_cast<unsigned>(record.flags) << ',';
+  if (record.flags & kRangeValid)
+  {
+    out_ << record.rangeMm;
+  }
+  out_ << ',' << record.clockOffsetPpm() << ',';
+  if (record.flags & kDiagValid)
+  {
+    out_ << record.firstPathIndex() << ',' << record.peakAmplitude() << ',' << record.cirPower << ','
+         << record.accumCount << ',' << record.rxLevelDbm();
+  }
+  else
+  {
+    out_ << ",,,,";
+  }
+  out_ << '\n';
+}
+
+void CsvWriter::finish()
+{
+  out_.flush();
+}
+
+ColumnarWriter::ColumnarWriter(std::ostream& out)
+  : out_(out)
+{
+}
+
+void ColumnarWriter::write(const RangeRecord& record)
+{
+  records_.push_back(record);
+}
+
+void ColumnarWriter::finish()
+{
+  const std::size_t rows = records_.size();
+  std::size_t offset = kHeaderLength + kColumns.size() * kDirectoryEntryLength;
+
+  out_.write(kMagic, sizeof(kMagic));
+  putLittleEndian(out_, kFormatVersion, 2);
+  putLittleEndian(out_, kColumns.size(), 2);
+  putLittleEndian(out_, rows, 8);
+
+  for (const Column& column : kColumns)
+  {
+    char name[kNameLength] = { 0 };
+
+    std::strncpy(name, column.name, kNameLength - 1);
+    out_.write(name, kNameLength);
+    out_.put(static_cast<char>(column.type));
+    padTo8(out_, kNameLength + 1);
+    putLittleEndian(out_, offset, 8);
+    offset += (rows * typeSize(column.type) + 7) / 8 * 8;
+  }
+
+  for (const Column& column : kColumns)
+  {
+    for (const RangeRecord& record : records_)
+    {
+      putValue(out_, column.type, column.value(record));
+    }
+    padTo8(out_, rows * typeSize(column.type));
+  }
+
+  out_.flush();
+}
+
+} // namespace uwb
@@ -0,0 +1,77 @@
+/*******************************************************************************
+  * File Name          : record_writers.h
+  * Description        :
+  *    Writes decoded range records as CSV, one row per record as they come,
+  *    or as a columnar file, written when the stream ends.
+  *
+  *    Columnar file, little endian:
+  *      char    magic[4]       "UWBC"
+  *      uint16  formatVersion  1
+  *      uint16  columnCount
+  *      uint64  rowCount
+  *      columnCount entries of 40 bytes:
+  *        char    name[24]     zero padded
+  *        uint8   type         ColumnType below
+  *        uint8   reserved[7]
+  *        uint64  offset       Of the column data from the start of the file, 8-byte aligned
+  *      column data: rowCount values of each column, one after the other
+  *    A column is read in one go, e.g. numpy.fromfile(path, "<i4", rowCount, offset=offset).
+  ******************************************************************************
+  */
+#ifndef UWB_RECORD_WRITERS_H_
+#define UWB_RECORD_WRITERS_H_
+
+#include "telemetry_decoder.h"
+
+#include <ostream>
+#include <vector>
+
+namespace uwb
+{
+
+enum class ColumnType : uint8_t
+{
+  U8 = 1,
+  U16 = 2,
+  U32 = 3,
+  I16 = 4,
+  I32 = 5,
+  F64 = 6,
+};
+
+class RecordWriter
+{
+public:
+  virtual ~RecordWriter() = default;
+  virtual void write(const RangeRecord& record) = 0;
+  virtual void finish() = 0;
+};
+
+// Fields that are not valid for a record (see its flags) are left empty
+class CsvWriter : public RecordWriter
+{
+public:
+  explicit CsvWriter(std::ostream& out);
+  void write(const RangeRecord& record) override;
+  void finish() override;
+
+private:
+  std::ostream& out_;
+};
+
+// Fields that are not valid for a record are 0, or NaN for the floating point columns
+class ColumnarWriter : public RecordWriter
+{
+public:
+  explicit ColumnarWriter(std::ostream& out);
+  void write(const RangeRecord& record) override;
+  void finish() override;
+
+private:
+  std::ostream& out_;
+  std::vector<RangeRecord> records_;
+};
+
+} // namespace uwb
+
+#endif /* UWB_RECORD_WRITERS_H_ */
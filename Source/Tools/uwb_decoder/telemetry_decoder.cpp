@@ -0,0 +1,228 @@
+/*******************************************************************************
+  * File Name          : telemetry_decoder.cpp
+  * Description        :
+  *    Host side decoder of the telemetry stream of the rangefinder.
+  ******************************************************************************
+  */
+#include "telemetry_decoder.h"
+
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace uwb
+{
+
+namespace
+{
+
+uint16_t get16(const uint8_t* src)
+{
+  return static_cast<uint16_t>(src[0] | src[1] << 8);
+}
+
+uint32_t get32(const uint8_t* src)
+{
+  return get16(src) | static_cast<uint32_t>(get16(src + 2)) << 16;
+}
+
+bool isText(const std::vector<uint8_t>& chunk)
+{
+  for (uint8_t c : chunk)
+  {
+    if ((c < 0x20 || c > 0x7E) && c != '\r' && c != '\n' && c != '\t')
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+double RangeRecord::clockOffsetPpm() const
+{
+  return clockOffset * 1e6 / (1 << 26);
+}
+
+double RangeRecord::firstPathIndex() const
+{
+  return fpIndex / 64.0;
+}
+
+uint32_t RangeRecord::peakAmplitude() const
+{
+  return cirPeak & 0x1FFFFF;
+}
+
+double RangeRecord::rxLevelDbm() const
+{
+  // DW3000 user manual: 10 log10(C * 2^21 / N^2) - A, with A = 121.7 dB at 64 MHz PRF
+  if (!(flags & kDiagValid) || cirPower == 0 || accumCount == 0)
+  {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  return 10.0 * std::log10(cirPower * 2097152.0 / (static_cast<double>(accumCount) * accumCount)) - 121.7;
+}
+
+// CRC-16/CCITT, poly 0x1021, init 0xFFFF, as computeCrc() in telemetry.c
+uint16_t crc16Ccitt(const uint8_t* data, std::size_t length)
+{
+  uint16_t crc = 0xFFFF;
+
+  while (length--)
+  {
+    crc ^= static_cast<uint16_t>(*data++) << 8;
+    for (int bit = 0; bit < 8; bit++)
+    {
+      crc = (crc & 0x8000) ? static_cast<uint16_t>(crc << 1 ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+    }
+  }
+
+  return crc;
+}
+
+// Decodes one COBS frame without its delimiter. Fails if it holds a zero or a code runs past the end.
+bool decodeCobs(const uint8_t* src, std::size_t length, std::vector<uint8_t>& dst)
+{
+  std::size_t i = 0;
+
+  dst.clear();
+  while (i < length)
+  {
+    const uint8_t code = src[i++];
+
+    if (code == 0 || i + code - 1 > length)
+    {
+      return false;
+    }
+    for (uint8_t j = 1; j < code; j++)
+    {
+      if (src[i] == 0)
+      {
+        return false;
+      }
+      dst.push_back(src[i++]);
+    }
+    if (code != 0xFF && i < length)
+    {
+      dst.push_back(0);
+    }
+  }
+
+  return true;
+}
+
+// Parses the fields of a record this decoder knows. Fields appended by newer versions are ignored.
+bool parseRecord(const uint8_t* data, std::size_t length, RangeRecord& record)
+{
+  if (length < kRecordLengthV1 || data[0] == 0 || data[0] >= kFirstFrameType)
+  {
+    return false;
+  }
+
+  record.version = data[0];
+  record.flags = data[1];
+  record.sequence = get16(&data[2]);
+  record.timestampMs = get32(&data[4]);
+  record.rangeMm = static_cast<int32_t>(get32(&data[8]));
+  record.clockOffset = static_cast<int16_t>(get16(&data[12]));
+  record.fpIndex = get16(&data[14]);
+  record.cirPeak = get32(&data[16]);
+  record.cirPower = get32(&data[20]);
+  record.accumCount = get16(&data[24]);
+
+  return true;
+}
+
+TelemetryDecoder::TelemetryDecoder(RecordHandler onRecord, TextHandler onText)
+  : onRecord_(std::move(onRecord)), onText_(std::move(onText))
+{
+  chunk_.reserve(kMaxChunkLength);
+}
+
+void TelemetryDecoder::feed(const uint8_t* data, std::size_t length)
+{
+  stats_.bytes += length;
+
+  for (std::size_t i = 0; i < length; i++)
+  {
+    if (data[i] == 0)
+    {
+      endChunk();
+    }
+    else if (chunk_.size() < kMaxChunkLength)
+    {
+      chunk_.push_back(data[i]);
+    }
+    else
+    {
+      overflow_ = true;
+    }
+  }
+}
+
+void TelemetryDecoder::endChunk()
+{
+  RangeRecord record;
+
+  if (chunk_.empty())
+  {
+    // Two delimiters in a row, between frames
+    return;
+  }
+
+  const bool isCobs = !overflow_ && decodeCobs(chunk_.data(), chunk_.size(), decoded_) && decoded_.size() > 2;
+  const bool isFrame = isCobs && crc16Ccitt(decoded_.data(), decoded_.size() - 2) == get16(&decoded_[decoded_.size() - 2]);
+
+  if (isFrame && parseRecord(decoded_.data(), decoded_.size() - 2, record))
+  {
+    // A clock going back means the rangefinder was reset and started counting from 0 again
+    if (haveSequence_ && record.timestampMs >= lastTimestampMs_)
+    {
+      stats_.lostRecords += static_cast<uint16_t>(record.sequence - lastSequence_ - 1);
+    }
+    haveSequence_ = true;
+    lastSequence_ = record.sequence;
+    lastTimestampMs_ = record.timestampMs;
+    stats_.records++;
+    onRecord_(record);
+  }
+  else if (isFrame && decoded_[0] == kLogFrameType)
+  {
+    stats_.logFrames++;
+  }
+  else if (isFrame && decoded_[0] == kCirFrameType)
+  {
+    stats_.cirFrames++;
+  }
+  else if (isFrame && decoded_[0] >= kFirstFrameType)
+  {
+    stats_.otherFrames++;
+  }
+  else if (isFrame)
+  {
+    stats_.unknownVersions++;
+  }
+  else if (!overflow_ && isText(chunk_))
+  {
+    stats_.textChunks++;
+    if (onText_)
+    {
+      onText_(std::string(chunk_.begin(), chunk_.end()));
+    }
+  }
+  else if (isCobs)
+  {
+    stats_.crcErrors++;
+  }
+  else
+  {
+    stats_.badChunks++;
+  }
+
+  chunk_.clear();
+  overflow_ = false;
+}
+
+} // namespace uwb
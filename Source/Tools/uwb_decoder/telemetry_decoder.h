@@ -0,0 +1,108 @@
+/*******************************************************************************
+  * File Name          : telemetry_decoder.h
+  * Description        :
+  *    Host side decoder of the telemetry stream of the rangefinder, see
+  *    Core/Inc/telemetry.h for the frame and record layout.
+  *
+  *    Bytes are fed in as they arrive, in pieces of any size. Every zero byte
+  *    ends a chunk. A chunk that decodes as COBS, passes the CRC and holds a
+  *    known record version is a record; anything else (printf text sharing
+  *    the UART, or a frame damaged on the line) is counted and skipped.
+  ******************************************************************************
+  */
+#ifndef UWB_TELEMETRY_DECODER_H_
+#define UWB_TELEMETRY_DECODER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace uwb
+{
+
+constexpr uint8_t kTelemetryVersion = 1;     // Newest record version this decoder knows
+constexpr std::size_t kRecordLengthV1 = 26;  // Record bytes of version 1, without the CRC
+constexpr std::size_t kMaxChunkLength = 8192; // Longer chunks cannot be frames, a full CIR dump is 6153 bytes
+constexpr uint8_t kFirstFrameType = 0x80;     // First bytes from here on are not record versions
+constexpr uint8_t kCirFrameType = 0xC1;       // CIR dump, see Tools/cir_dump.py
+constexpr uint8_t kLogFrameType = 0xF0;       // Tokenised log message, see Tools/tlog_decode.py
+
+// Record flags, as in telemetry.h
+enum RecordFlags : uint8_t
+{
+  kRangeValid = 0x01,
+  kRxTimeout = 0x02,
+  kRxError = 0x04,
+  kBadFrame = 0x08,
+  kDiagValid = 0x10,
+  kLogDropped = 0x20,
+};
+
+struct RangeRecord
+{
+  uint8_t version;
+  uint8_t flags;
+  uint16_t sequence;
+  uint32_t timestampMs;
+  int32_t rangeMm;
+  int16_t clockOffset;
+  uint16_t fpIndex;
+  uint32_t cirPeak;
+  uint32_t cirPower;
+  uint16_t accumCount;
+
+  // Derived values
+  double clockOffsetPpm() const;
+  double firstPathIndex() const;  // In CIR samples
+  uint32_t peakAmplitude() const;
+  double rxLevelDbm() const;      // Estimated receive level, 64 MHz PRF; NaN without diagnostics
+};
+
+struct DecoderStats
+{
+  uint64_t bytes = 0;
+  uint64_t records = 0;
+  uint64_t lostRecords = 0;    // From gaps in the sequence numbers
+  uint64_t crcErrors = 0;
+  uint64_t badChunks = 0;      // Not COBS, too short or too long
+  uint64_t textChunks = 0;     // Printable text, e.g. printf output
+  uint64_t unknownVersions = 0;
+  uint64_t logFrames = 0;      // Tokenised log messages, skipped
+  uint64_t cirFrames = 0;      // CIR dumps, skipped
+  uint64_t otherFrames = 0;    // Other frame types, e.g. flash log dumps, skipped
+};
+
+uint16_t crc16Ccitt(const uint8_t* data, std::size_t length);
+bool decodeCobs(const uint8_t* src, std::size_t length, std::vector<uint8_t>& dst);
+bool parseRecord(const uint8_t* data, std::size_t length, RangeRecord& record);
+
+class TelemetryDecoder
+{
+public:
+  using RecordHandler = std::function<void(const RangeRecord&)>;
+  using TextHandler = std::function<void(const std::string&)>;
+
+  explicit TelemetryDecoder(RecordHandler onRecord, TextHandler onText = nullptr);
+
+  void feed(const uint8_t* data, std::size_t length);
+  const DecoderStats& stats() const { return stats_; }
+
+private:
+  void endChunk();
+
+  RecordHandler onRecord_;
+  TextHandler onText_;
+  std::vector<uint8_t> chunk_;
+  std::vector<uint8_t> decoded_;
+  bool overflow_ = false;
+  bool haveSequence_ = false;
+  uint16_t lastSequence_ = 0;
+  uint32_t lastTimestampMs_ = 0;
+  DecoderStats stats_;
+};
+
+} // namespace uwb
+
+#endif /* UWB_TELEMETRY_DECODER_H_ */
@@ -0,0 +1,150 @@
+/*******************************************************************************
+  * File Name          : uwb_decode.cpp
+  * Description        :
+  *    Converts the telemetry stream of the rangefinder to CSV or to a
+  *    columnar file. Reads a capture file, or a serial port set to raw mode.
+  *
+  *    Usage: uwb_decode [-f csv|columnar] [-o output] [-t] [input]
+  *      -f  output format, csv by default
+  *      -o  output file, standard output by default (csv only)
+  *      -t  print the text found between records (printf output) to stderr
+  *      input defaults to standard input
+  *    Statistics are printed to stderr at the end.
+  ******************************************************************************
+  */
+#include "record_writers.h"
+#include "telemetry_decoder.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+void printUsage()
+{
+  std::cerr << "Usage: uwb_decode [-f csv|columnar] [-o output] [-t] [input]\n";
+}
+
+void printStats(const uwb::DecoderStats& stats)
+{
+  std::cerr << "bytes " << stats.bytes
+            << ", records " << stats.records
+            << ", lost records " << stats.lostRecords
+            << ", CRC errors " << stats.crcErrors
+            << ", bad chunks " << stats.badChunks
+            << ", text chunks " << stats.textChunks
+            << ", unknown versions " << stats.unknownVersions
+            << ", log messages " << stats.logFrames
+            << ", CIR dumps " << stats.cirFrames
+            << ", other frames " << stats.otherFrames << "\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::string format = "csv";
+  std::string outputPath;
+  std::string inputPath;
+  bool echoText = false;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (!std::strcmp(argv[i], "-f") && i + 1 < argc)
+    {
+      format = argv[++i];
+    }
+    else if (!std::strcmp(argv[i], "-o") && i + 1 < argc)
+    {
+      outputPath = argv[++i];
+    }
+    else if (!std::strcmp(argv[i], "-t"))
+    {
+      echoText = true;
+    }
+    else if (argv[i][0] != '-' && inputPath.empty())
+    {
+      inputPath = argv[i];
+    }
+    else
+    {
+      printUsage();
+      return 2;
+    }
+  }
+
+  if ((format != "csv" && format != "columnar") || (format == "columnar" && outputPath.empty()))
+  {
+    printUsage();
+    return 2;
+  }
+
+  std::FILE* input = inputPath.empty() ? stdin : std::fopen(inputPath.c_str(), "rb");
+  if (input == nullptr)
+  {
+    std::cerr << "Cannot open " << inputPath << "\n";
+    return 1;
+  }
+
+  std::ofstream outputFile;
+  if (!outputPath.empty())
+  {
+    outputFile.open(outputPath, std::ios::binary);
+    if (!outputFile)
+    {
+      std::cerr << "Cannot create " << outputPath << "\n";
+      return 1;
+    }
+  }
+  std::ostream& output = outputPath.empty() ? std::cout : outputFile;
+
+  std::unique_ptr<uwb::RecordWriter> writer;
+  if (format == "csv")
+  {
+    writer.reset(new uwb::CsvWriter(output));
+  }
+  else
+  {
+    writer.reset(new uwb::ColumnarWriter(output));
+  }
+
+  uwb::TelemetryDecoder decoder(
+    [&writer](const uwb::RangeRecord& record) { writer->write(record); },
+    [echoText](const std::string& text) { if (echoText) std::cerr << text; });
+
+  // read() returns what a serial port has so far instead of waiting for a full buffer;
+  // the decoder takes any piece of the stream
+  uint8_t buffer[4096];
+#ifdef _WIN32
+  std::size_t length;
+  while ((length = std::fread(buffer, 1, sizeof(buffer), input)) > 0)
+#else
+  ssize_t length;
+  while ((length = read(fileno(input), buffer, sizeof(buffer))) > 0)
+#endif
+  {
+    decoder.feed(buffer, length);
+    if (format == "csv")
+    {
+      output.flush();
+    }
+  }
+
+  writer->finish();
+  printStats(decoder.stats());
+
+  if (input != stdin)
+  {
+    std::fclose(input);
+  }
+  return 0;
+}